@@ -0,0 +1,526 @@
+// Load-path benchmark: runs every LogParser engine over one log file and
+// reports MB/s, lines/s, peak RSS and heap allocations for each, so
+// regressions show up before a build ships. Without a FILE, a log is
+// generated into the temp directory first.
+//
+//   log_engine_bench [--engines a,b,...] [--threads N] [--repeat N] [--tsv]
+//                    [--baseline FILE --tolerance PCT] [--generate MB] [FILE]
+//
+// --tsv output saved from one build can be passed as --baseline to a later
+// one; the exit status is 1 if an engine got slower by more than the
+// tolerance (default 10%) or the engines disagree on the entry count.
+
+#include "LogGenerator.hpp"
+#include "LogParser.hpp"
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#undef ERROR
+#elif !defined(__linux__)
+#include <sys/resource.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Heap allocation counting: every operator new in the process goes through here
+// -----------------------------------------------------------------------------
+
+static std::atomic<size_t> allocation_count{0};
+static std::atomic<size_t> allocated_bytes{0};
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+// GCC takes the free() of memory from the replaced operator new, once
+// inlined, for a mismatched pair
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// -----------------------------------------------------------------------------
+// Peak resident memory
+// -----------------------------------------------------------------------------
+
+// Start a new peak measurement. Returns false where the peak can't be reset
+// (then it's the high-water mark of the whole process).
+static bool resetPeakRss() {
+#if defined(__GLIBC__)
+    // Hand freed heap back first, so earlier runs don't count towards the peak
+    malloc_trim(0);
+#endif
+#if defined(__linux__)
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return static_cast<bool>(clear_refs);
+#else
+    return false;
+#endif
+}
+
+static size_t peakRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Engines
+// -----------------------------------------------------------------------------
+
+// Time and allocations of one load, up to the point the engine has its
+// result (tearing the result down isn't part of the load)
+struct Measurement {
+    std::chrono::steady_clock::time_point started;
+    double seconds = 0;
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+    void start() {
+        allocations = allocation_count.load();
+        bytes = allocated_bytes.load();
+        started = std::chrono::steady_clock::now();
+    }
+
+    void stop() {
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        allocations = allocation_count.load() - allocations;
+        bytes = allocated_bytes.load() - bytes;
+    }
+};
+
+struct Engine {
+    const char* name;
+    const char* description;
+    size_t input_copies;   // Times the file is read per run
+    // Load path with parser, calling measurement.start()/stop() around the
+    // load, and return the number of entries
+    std::function<size_t(const std::string& path, LogParser& parser, Measurement& measurement)> run;
+};
+
+static void waitForParser(const LogParser& parser) {
+    while (parser.isParsingInProgress()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static const auto NO_PROGRESS = [](const std::string&) {};
+
+static std::vector<Engine> allEngines() {
+    return {
+        {"parse", "synchronous, owning LogEntry vector", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             measurement.start();
+             std::vector<LogEntry> entries = parser.parse(path);
+             measurement.stop();
+             return entries.size();
+         }},
+        {"parseAsync", "background, owning LogEntry vector", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             std::vector<LogEntry> entries;
+             std::mutex mutex;
+             measurement.start();
+             parser.parseAsync(path, entries, mutex, NO_PROGRESS);
+             waitForParser(parser);
+             measurement.stop();
+             return entries.size();
+         }},
+        {"parseAsync-store", "background, text copied into store arenas", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             LogStore store;
+             std::mutex mutex;
+             measurement.start();
+             parser.parseAsync(path, store, mutex, NO_PROGRESS);
+             waitForParser(parser);
+             measurement.stop();
+             return store.size();
+         }},
+        {"parseMapped", "memory-mapped, views into the mapping", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             LogStore store;
+             measurement.start();
+             parser.parseMapped(path, store);
+             measurement.stop();
+             return store.size();
+         }},
+        {"parseMappedAsync", "memory-mapped in the background", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             LogStore store;
+             std::mutex mutex;
+             measurement.start();
+             parser.parseMappedAsync(path, store, mutex, NO_PROGRESS);
+             waitForParser(parser);
+             measurement.stop();
+             return store.size();
+         }},
+        {"parseMapped-lazy", "memory-mapped, rows decoded on access", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             LogStore store;
+             parser.setLazyDecoding(true);
+             measurement.start();
+             parser.parseMapped(path, store);
+             measurement.stop();
+             return store.size();
+         }},
+        {"parseMapped-cached", "memory-mapped, restored from the index cache", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             // Write the cache first. A cache the input already had is
+             // the user's and is kept; one written here is removed again.
+             std::error_code error;
+             bool had_cache = std::filesystem::exists(path + ".lrindex", error);
+             parser.setIndexCacheEnabled(true);
+             {
+                 LogStore store;
+                 parser.parseMapped(path, store);
+             }
+             LogStore store;
+             measurement.start();
+             parser.parseMapped(path, store);
+             measurement.stop();
+             if (!had_cache) {
+                 std::filesystem::remove(path + ".lrindex", error);
+             }
+             return store.size();
+         }},
+        {"parseEntries", "streaming visitor, nothing kept", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             size_t entries = 0;
+             measurement.start();
+             parser.parseEntries(path, [&](const LogEntryView&) {
+                 entries++;
+                 return true;
+             });
+             measurement.stop();
+             return entries;
+         }},
+        {"parseEntries-stream", "streaming visitor over an istream", 1,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             std::ifstream input(path, std::ios::binary);
+             size_t entries = 0;
+             measurement.start();
+             parser.parseEntries(input, [&](const LogEntryView&) {
+                 entries++;
+                 return true;
+             });
+             measurement.stop();
+             return entries;
+         }},
+        {"parseMerged-2x", "k-way merge of the file with itself", 2,
+         [](const std::string& path, LogParser& parser, Measurement& measurement) {
+             LogStore store;
+             measurement.start();
+             parser.parseMerged({path, path}, store);
+             measurement.stop();
+             return store.size();
+         }},
+    };
+}
+
+// -----------------------------------------------------------------------------
+// Driver
+// -----------------------------------------------------------------------------
+
+struct BenchOptions {
+    std::vector<std::string> engines;   // Empty for all
+    unsigned threads = 0;
+    unsigned repeat = 3;
+    bool tsv = false;
+    std::string baseline;
+    double tolerance = 0.10;
+    double generate_mb = 200;
+    std::string file;
+};
+
+struct Result {
+    const Engine* engine;
+    double seconds;
+    double mb_per_second;
+    double lines_per_second;
+    size_t entries;
+    size_t peak_rss;
+    size_t allocations;
+    size_t allocated_bytes;
+};
+
+static void printUsage() {
+    std::fputs("Usage: log_engine_bench [options] [FILE]\n"
+               "  --engines LIST    Comma-separated engines to run (default all)\n"
+               "  --threads N       Parser threads (default all cores)\n"
+               "  --repeat N        Runs per engine; the fastest is reported (default 3)\n"
+               "  --tsv             Tab-separated output, usable as a baseline\n"
+               "  --baseline FILE   Fail if an engine's MB/s dropped versus this --tsv output\n"
+               "  --tolerance PCT   Allowed MB/s drop for --baseline (default 10)\n"
+               "  --generate MB     Size of the generated log when no FILE is given (default 200)\n"
+               "\nEngines:\n", stderr);
+    for (const Engine& engine : allEngines()) {
+        std::fprintf(stderr, "  %-20s %s\n", engine.name, engine.description);
+    }
+}
+
+static bool parseArguments(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tsv") {
+            options.tsv = true;
+            continue;
+        }
+        if (arg.size() < 2 || arg.compare(0, 2, "--") != 0) {
+            options.file = arg;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--engines") {
+            std::istringstream names(value);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                options.engines.push_back(name);
+            }
+        } else if (arg == "--threads") {
+            options.threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--repeat") {
+            options.repeat = std::max(1u, static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10)));
+        } else if (arg == "--baseline") {
+            options.baseline = value;
+        } else if (arg == "--tolerance") {
+            options.tolerance = std::atof(value.c_str()) / 100.0;
+        } else if (arg == "--generate") {
+            options.generate_mb = std::atof(value.c_str());
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// MB/s per engine from earlier --tsv output
+static std::map<std::string, double> loadBaseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream input(path);
+    std::string line;
+    std::getline(input, line);   // Header
+    while (std::getline(input, line)) {
+        std::istringstream fields(line);
+        std::string name, seconds, mb_per_second;
+        if (std::getline(fields, name, '\t') && std::getline(fields, seconds, '\t') &&
+            std::getline(fields, mb_per_second, '\t')) {
+            baseline[name] = std::atof(mb_per_second.c_str());
+        }
+    }
+    return baseline;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<Engine> engines;
+    for (const Engine& engine : allEngines()) {
+        if (options.engines.empty() ||
+            std::find(options.engines.begin(), options.engines.end(), engine.name) != options.engines.end()) {
+            engines.push_back(engine);
+        }
+    }
+    if (engines.empty()) {
+        std::fputs("log_engine_bench: no such engine\n", stderr);
+        printUsage();
+        return 2;
+    }
+
+    // Generate a log when none is given
+    bool generated = options.file.empty();
+    if (generated) {
+        options.file = (std::filesystem::temp_directory_path() / "log_engine_bench.log").string();
+        LogGeneratorOptions generator;
+        generator.bytes = static_cast<size_t>(options.generate_mb * 1024 * 1024);
+        std::FILE* out = std::fopen(options.file.c_str(), "wb");
+        bool written = out && writeLog(generator, out) > 0;
+        if (out) {
+            written = std::fclose(out) == 0 && written;
+        }
+        if (!written) {
+            std::fprintf(stderr, "log_engine_bench: cannot write %s\n", options.file.c_str());
+            return 2;
+        }
+    }
+
+    // Read the file once so every engine starts from a warm page cache
+    size_t file_bytes = 0;
+    size_t file_lines = 0;
+    {
+        MappedFile file;
+        if (!file.open(options.file)) {
+            std::fprintf(stderr, "log_engine_bench: cannot read %s\n", options.file.c_str());
+            return 2;
+        }
+        std::string_view text = file.view();
+        file_bytes = text.size();
+        file_lines = static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+        if (!text.empty() && text.back() != '\n') {
+            file_lines++;
+        }
+    }
+
+    bool resettable_rss = resetPeakRss();
+    if (!options.tsv) {
+        std::printf("%s: %.1f MB, %zu lines, %u threads, best of %u\n", options.file.c_str(),
+                    file_bytes / (1024.0 * 1024.0), file_lines,
+                    options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency()),
+                    options.repeat);
+        if (!resettable_rss) {
+            std::printf("(peak RSS is the process high-water mark; use --engines to measure one at a time)\n");
+        }
+        std::printf("%-20s %9s %9s %12s %10s %10s %10s %10s\n", "engine", "seconds", "MB/s", "lines/s",
+                    "entries", "RSS MB", "allocs", "alloc MB");
+    } else {
+        std::printf("engine\tseconds\tmb_per_s\tlines_per_s\tentries\tpeak_rss_bytes\tallocations\tallocated_bytes\n");
+    }
+
+    std::vector<Result> results;
+    for (const Engine& engine : engines) {
+        Result result{&engine, 0, 0, 0, 0, 0, 0, 0};
+        for (unsigned run = 0; run < options.repeat; ++run) {
+            LogParser parser;
+            parser.setThreadCount(options.threads);
+            parser.setIndexCacheEnabled(false);
+
+            resetPeakRss();
+            Measurement measurement;
+            size_t entries = engine.run(options.file, parser, measurement);
+            size_t peak = peakRssBytes();
+
+            if (run == 0 || measurement.seconds < result.seconds) {
+                result.seconds = measurement.seconds;
+            }
+            result.entries = entries;
+            result.peak_rss = std::max(result.peak_rss, peak);
+            result.allocations = measurement.allocations;
+            result.allocated_bytes = measurement.bytes;
+        }
+        double seconds = std::max(result.seconds, 1e-9);
+        result.mb_per_second = engine.input_copies * file_bytes / (1024.0 * 1024.0) / seconds;
+        result.lines_per_second = engine.input_copies * file_lines / seconds;
+        results.push_back(result);
+
+        if (options.tsv) {
+            std::printf("%s\t%.6f\t%.2f\t%.0f\t%zu\t%zu\t%zu\t%zu\n", engine.name, result.seconds,
+                        result.mb_per_second, result.lines_per_second, result.entries, result.peak_rss,
+                        result.allocations, result.allocated_bytes);
+        } else {
+            std::printf("%-20s %9.3f %9.1f %12.0f %10zu %10.1f %10zu %10.1f\n", engine.name, result.seconds,
+                        result.mb_per_second, result.lines_per_second, result.entries,
+                        result.peak_rss / (1024.0 * 1024.0), result.allocations,
+                        result.allocated_bytes / (1024.0 * 1024.0));
+        }
+        std::fflush(stdout);
+    }
+
+    int status = 0;
+
+    // Every engine should find the same entries (per copy of the input)
+    for (const Result& result : results) {
+        const Result& first = results.front();
+        if (result.entries * first.engine->input_copies != first.entries * result.engine->input_copies) {
+            std::fprintf(stderr, "MISMATCH: %s found %zu entries, %s found %zu\n", result.engine->name,
+                         result.entries, first.engine->name, first.entries);
+            status = 1;
+        }
+    }
+
+    if (!options.baseline.empty()) {
+        std::map<std::string, double> baseline = loadBaseline(options.baseline);
+        for (const Result& result : results) {
+            auto previous = baseline.find(result.engine->name);
+            if (previous == baseline.end() || previous->second <= 0) continue;
+            double change = result.mb_per_second / previous->second - 1.0;
+            if (change < -options.tolerance) {
+                std::fprintf(stderr, "REGRESSION: %s %.1f MB/s, baseline %.1f MB/s (%+.0f%%)\n",
+                             result.engine->name, result.mb_per_second, previous->second, change * 100);
+                status = 1;
+            }
+        }
+    }
+
+    if (generated) {
+        std::error_code error;
+        std::filesystem::remove(options.file, error);
+    }
+    return status;
+}
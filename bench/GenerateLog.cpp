@@ -0,0 +1,120 @@
+// Synthetic log generator for the benchmarks and for trying the viewer on
+// large files.
+//
+//   log_generator [--size MB] [--levels D,I,W,E] [--message-length MEAN[,MAX]]
+//                 [--malformed RATE] [--untimed RATE] [--rate LINES_PER_S]
+//                 [--seed N] OUTPUT
+
+#include "LogGenerator.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static void printUsage() {
+    std::fputs("Usage: log_generator [options] OUTPUT (- for stdout)\n"
+               "  --size MB                 Bytes to write, in MiB (default 100)\n"
+               "  --levels D,I,W,E          Relative weights of DEBUG, INFO, WARN, ERROR (default 30,50,15,5)\n"
+               "  --message-length MEAN[,MAX]  Message length distribution (default 80,1000)\n"
+               "  --malformed RATE          Fraction of lines the parser must skip (default 0.001)\n"
+               "  --untimed RATE            Fraction of entries without a parseable time (default 0)\n"
+               "  --rate N                  Lines per second of log time (default 2000)\n"
+               "  --seed N                  Random seed (default 1)\n", stderr);
+}
+
+// Parse "a,b,..." into at most count unsigned values; false on junk
+static bool parseList(const char* text, size_t* values, size_t count, size_t& parsed) {
+    parsed = 0;
+    while (*text && parsed < count) {
+        char* end;
+        unsigned long long value = std::strtoull(text, &end, 10);
+        if (end == text || (*end && *end != ',')) {
+            return false;
+        }
+        values[parsed++] = static_cast<size_t>(value);
+        text = *end ? end + 1 : end;
+    }
+    return *text == '\0';
+}
+
+int main(int argc, char** argv) {
+    LogGeneratorOptions options;
+    const char* output = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (arg.size() < 2 || arg[0] != '-' || arg[1] != '-') {
+            output = argv[i];
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "log_generator: %s needs a value\n", argv[i]);
+            return 2;
+        }
+        const char* value = argv[++i];
+        size_t values[4];
+        size_t parsed = 0;
+        bool ok = true;
+        if (arg == "--size") {
+            double megabytes = std::atof(value);
+            ok = megabytes > 0;
+            options.bytes = static_cast<size_t>(megabytes * 1024 * 1024);
+        } else if (arg == "--levels") {
+            ok = parseList(value, values, 4, parsed) && parsed == 4;
+            for (size_t level = 0; ok && level < 4; ++level) {
+                options.level_weights[level] = static_cast<unsigned>(values[level]);
+            }
+        } else if (arg == "--message-length") {
+            ok = parseList(value, values, 2, parsed) && parsed >= 1 && values[0] > 0;
+            if (ok) {
+                options.mean_message_length = values[0];
+                options.max_message_length = parsed == 2 ? values[1] : std::max<size_t>(values[0] * 12, 8);
+            }
+        } else if (arg == "--malformed" || arg == "--untimed") {
+            double rate = std::atof(value);
+            ok = rate >= 0 && rate <= 1;
+            (arg == "--malformed" ? options.malformed_rate : options.untimed_rate) = rate;
+        } else if (arg == "--rate") {
+            ok = parseList(value, values, 1, parsed) && parsed == 1 && values[0] > 0;
+            options.lines_per_second = values[0];
+        } else if (arg == "--seed") {
+            ok = parseList(value, values, 1, parsed) && parsed == 1;
+            options.seed = static_cast<uint32_t>(values[0]);
+        } else {
+            std::fprintf(stderr, "log_generator: unknown option %s\n", argv[i - 1]);
+            printUsage();
+            return 2;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "log_generator: invalid value '%s' for %s\n", value, argv[i - 1]);
+            return 2;
+        }
+    }
+
+    if (!output) {
+        printUsage();
+        return 2;
+    }
+    bool to_stdout = std::strcmp(output, "-") == 0;
+    std::FILE* out = to_stdout ? stdout : std::fopen(output, "wb");
+    if (!out) {
+        std::fprintf(stderr, "log_generator: cannot write %s\n", output);
+        return 2;
+    }
+
+    size_t lines = writeLog(options, out);
+    if (!to_stdout) {
+        lines = std::fclose(out) == 0 ? lines : 0;
+    }
+    if (lines == 0) {
+        std::fprintf(stderr, "log_generator: writing %s failed\n", output);
+        return 2;
+    }
+    std::fprintf(stderr, "%zu lines written to %s\n", lines, output);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "LogGenerator.hpp"
+#include "LineParser.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+
+static const char* const LEVELS[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+static const char* const WORDS[] = {
+    "vkCreateSwapchainKHR", "frame", "texture", "loaded", "from", "cache", "in", "ms",
+    "descriptor", "pool", "allocated", "pipeline", "compiled", "shader", "module", "buffer",
+    "upload", "queued", "fence", "signaled", "after", "timeout", "device", "memory", "heap",
+    "resize", "swapchain", "recreated", "render", "pass", "begin", "end", "submit", "present",
+};
+
+static const char* const SOURCE_FILES[] = {
+    "Vulkan.cpp", "Swapchain.cpp", "Renderer.cpp", "TextureCache.cpp", "ShaderCompiler.cpp",
+    "DescriptorAllocator.cpp", "UploadQueue.cpp", "Window.cpp",
+};
+
+static const char* const SOURCE_FUNCTIONS[] = {
+    "initVulkan", "createSwapchain", "recordCommandBuffer", "loadTexture", "compilePipeline",
+    "allocateDescriptorSet", "flushUploads", "pollEvents",
+};
+
+template <typename T, size_t N>
+static constexpr size_t countOf(const T (&)[N]) { return N; }
+
+// Generates one line at a time from the options' random stream
+class LineWriter {
+public:
+    explicit LineWriter(const LogGeneratorOptions& options) : options(options), rng(options.seed) {
+        for (unsigned weight : options.level_weights) {
+            total_weight += weight;
+        }
+    }
+
+    void appendLine(std::string& out) {
+        time_ms += -std::log(1.0 - uniform()) * 1000.0 / static_cast<double>(options.lines_per_second);
+        if (uniform() < options.malformed_rate) {
+            appendMalformed(out);
+        } else {
+            appendEntry(out);
+        }
+        out += '\n';
+    }
+
+private:
+    const LogGeneratorOptions& options;
+    std::mt19937 rng;
+    unsigned total_weight = 0;
+    double time_ms = 8 * 3600 * 1000.0;   // Logs start at 08:00 and run past midnight if long enough
+
+    double uniform() { return rng() / 4294967296.0; }
+    size_t below(size_t n) { return static_cast<size_t>(uniform() * n); }
+
+    void appendTimestamp(std::string& out) {
+        if (uniform() < options.untimed_rate) {
+            out += "--:--:--.---";
+            return;
+        }
+        long long ms = static_cast<long long>(time_ms) % (24 * 3600 * 1000LL);
+        char text[32];
+        std::snprintf(text, sizeof(text), "%02lld:%02lld:%02lld.%03lld",
+                      ms / 3600000, ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+        out += text;
+    }
+
+    void appendMessage(std::string& out) {
+        double length = -std::log(1.0 - uniform()) * static_cast<double>(options.mean_message_length);
+        size_t target = std::min(options.max_message_length, std::max<size_t>(8, static_cast<size_t>(length)));
+        // Whole words until the target length is reached
+        size_t start = out.size();
+        while (out.size() - start < target) {
+            if (out.size() > start) out += ' ';
+            if (below(4) == 0) {
+                out += std::to_string(below(100000));
+            } else {
+                out += WORDS[below(countOf(WORDS))];
+            }
+        }
+        if (out.size() - start > options.max_message_length) {
+            out.resize(start + options.max_message_length);
+        }
+    }
+
+    void appendEntry(std::string& out) {
+        appendTimestamp(out);
+        out += FIELD_SEPARATOR;
+        unsigned pick = total_weight ? static_cast<unsigned>(below(total_weight)) : 0;
+        size_t level = 0;
+        while (level < 3 && pick >= options.level_weights[level]) {
+            pick -= options.level_weights[level++];
+        }
+        out += LEVELS[level];
+        out += FIELD_SEPARATOR;
+        appendMessage(out);
+        out += FIELD_SEPARATOR;
+        size_t source = below(countOf(SOURCE_FILES));
+        out += SOURCE_FILES[source];
+        out += " -> ";
+        out += SOURCE_FUNCTIONS[(source + below(2)) % countOf(SOURCE_FUNCTIONS)];
+        out += "(): ";
+        out += std::to_string(1 + below(2000));
+    }
+
+    // Lines the parsers have to skip: no separators at all, an entry cut
+    // short before its source field, or an empty line
+    void appendMalformed(std::string& out) {
+        switch (below(3)) {
+            case 0:
+                appendMessage(out);
+                break;
+            case 1:
+                appendTimestamp(out);
+                out += FIELD_SEPARATOR;
+                out += LEVELS[below(4)];
+                out += FIELD_SEPARATOR;
+                appendMessage(out);
+                break;
+            default:
+                break;
+        }
+    }
+};
+
+size_t writeLog(const LogGeneratorOptions& options, std::FILE* out) {
+    const size_t BUFFER_BYTES = 1024 * 1024;
+    LineWriter writer(options);
+    std::string buffer;
+    buffer.reserve(BUFFER_BYTES + 4096);
+    size_t written = 0;
+    size_t lines = 0;
+
+    while (written < options.bytes) {
+        buffer.clear();
+        while (buffer.size() < BUFFER_BYTES && written + buffer.size() < options.bytes) {
+            writer.appendLine(buffer);
+            lines++;
+        }
+        if (std::fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size()) {
+            return 0;
+        }
+        written += buffer.size();
+    }
+    return std::fflush(out) == 0 ? lines : 0;
+}
@@ -0,0 +1,27 @@
+#ifndef LOG_GENERATOR_HPP
+#define LOG_GENERATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Synthetic logs in the README format for the benchmarks. Output depends
+// only on the options, so a seed always generates the same file; random
+// numbers come straight from mt19937 rather than the standard
+// distributions, whose output differs between standard libraries.
+struct LogGeneratorOptions {
+    size_t bytes = 100 * 1024 * 1024;        // Stop after the line that reaches this size
+    unsigned level_weights[4] = {30, 50, 15, 5};   // DEBUG, INFO, WARN, ERROR
+    size_t mean_message_length = 80;         // Exponentially distributed: mostly short, a long tail
+    size_t max_message_length = 1000;
+    double malformed_rate = 0.001;           // Lines with missing fields or no separators
+    double untimed_rate = 0.0;               // Entries whose timestamp isn't a time
+    size_t lines_per_second = 2000;          // Timestamps advance at about this rate
+    uint32_t seed = 1;
+};
+
+// Write lines to out until options.bytes have been written. Returns the
+// number of lines, or 0 if writing failed.
+size_t writeLog(const LogGeneratorOptions& options, std::FILE* out);
+
+#endif // LOG_GENERATOR_HPP
@@ -0,0 +1,206 @@
+// Parser throughput benchmark. Generates README-format log lines in memory
+// and reports lines/s for source-info parsing (previous std::regex version
+// vs. the current scanner), level names (previous comparison chain vs. the
+// perfect hash), whole-line parsing and whole-buffer parsing.
+//
+//   log_parser_bench [line_count]
+
+#include "LineParser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Source-info parsing as it was before the hand-written scanner
+static void parseSourceInfoRegex(std::string_view source_info, LogEntryView& entry) {
+    static const std::regex source_re(R"((.*)\s*->\s*(.*)\(\):\s*(\d+))");
+    std::cmatch source_match;
+    if (std::regex_match(source_info.data(), source_info.data() + source_info.size(), source_match, source_re)) {
+        entry.source_file = std::string_view(source_match[1].first, source_match[1].length());
+        entry.source_function = std::string_view(source_match[2].first, source_match[2].length());
+        entry.source_line = std::stoi(source_match[3].str());
+    } else {
+        entry.source_file = source_info;
+        entry.source_function = "unknown";
+        entry.source_line = 0;
+    }
+}
+
+// Level parsing as it was before the perfect hash
+static LogLevel parseLogLevelChain(std::string_view level_str) {
+    size_t first = level_str.find_first_not_of(" \t");
+    if (first == std::string_view::npos) {
+        return LogLevel::DEBUG;
+    }
+    level_str = level_str.substr(first, level_str.find_last_not_of(" \t") - first + 1);
+
+    if (level_str == "DEBUG") {
+        return LogLevel::DEBUG;
+    } else if (level_str == "INFO") {
+        return LogLevel::INFO;
+    } else if (level_str == "WARN") {
+        return LogLevel::WARN;
+    } else if (level_str == "ERROR") {
+        return LogLevel::ERROR;
+    } else if (level_str == "FOOTER") {
+        return LogLevel::FOOTER;
+    } else if (level_str == "HEADER") {
+        return LogLevel::HEADER;
+    }
+    return LogLevel::DEBUG;
+}
+
+static std::vector<std::string> generateLines(size_t line_count) {
+    const char* levels[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+    const char* functions[] = {"initVulkan", "createSwapchain", "recordCommandBuffer", "loadTexture"};
+    const char* files[] = {"Vulkan.cpp", "Swapchain.cpp", "Renderer.cpp", "TextureCache.cpp"};
+    
+    std::vector<std::string> lines;
+    lines.reserve(line_count);
+    for (size_t i = 0; i < line_count; ++i) {
+        std::string line = "16:29:40.318";
+        line += FIELD_SEPARATOR;
+        line += levels[i % 4];
+        line += FIELD_SEPARATOR;
+        line += "Vulkan loader version: 1.4.304 frame " + std::to_string(i);
+        line += FIELD_SEPARATOR;
+        if (i % 100 == 0) {
+            line += "no source information";  // Exercise the fallback path
+        } else {
+            line += std::string(files[(i / 4) % 4]) + " -> " + functions[(i / 16) % 4] + "(): " + std::to_string(i % 2000);
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+template <typename Fn>
+static double measureSeconds(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* name, size_t lines, double seconds) {
+    std::printf("%-28s %10.3f s %14.0f lines/s\n", name, seconds, lines / seconds);
+}
+
+int main(int argc, char** argv) {
+    size_t line_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::vector<std::string> lines = generateLines(line_count);
+    
+    std::vector<std::string_view> source_infos;
+    source_infos.reserve(lines.size());
+    for (const auto& line : lines) {
+        source_infos.push_back(std::string_view(line).substr(line.rfind(FIELD_SEPARATOR) + 1));
+    }
+    
+    std::vector<LogEntryView> regex_results(lines.size());
+    std::vector<LogEntryView> scanner_results(lines.size());
+    
+    double regex_seconds = measureSeconds([&] {
+        for (size_t i = 0; i < source_infos.size(); ++i) {
+            parseSourceInfoRegex(source_infos[i], regex_results[i]);
+        }
+    });
+    double scanner_seconds = measureSeconds([&] {
+        for (size_t i = 0; i < source_infos.size(); ++i) {
+            parseSourceInfo(source_infos[i], scanner_results[i]);
+        }
+    });
+    
+    size_t mismatches = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const auto& a = regex_results[i];
+        const auto& b = scanner_results[i];
+        if (a.source_file != b.source_file || a.source_function != b.source_function || a.source_line != b.source_line) {
+            mismatches++;
+        }
+    }
+    
+    // Level names of the lines, plus some that aren't levels
+    const char* level_names[] = {"DEBUG", "INFO", "WARN", "ERROR", "HEADER", "FOOTER", "TRACE", "BOGUS"};
+    std::vector<std::string_view> level_strs;
+    level_strs.reserve(lines.size());
+    uint32_t pick = 1;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        pick = pick * 1664525u + 1013904223u;  // Unpredictable order
+        level_strs.push_back(level_names[pick >> 29]);
+    }
+    unsigned chain_sum = 0;
+    unsigned hash_sum = 0;
+    double chain_seconds = measureSeconds([&] {
+        for (std::string_view level_str : level_strs) {
+            chain_sum += static_cast<unsigned>(parseLogLevelChain(level_str));
+        }
+    });
+    double hash_seconds = measureSeconds([&] {
+        for (std::string_view level_str : level_strs) {
+            hash_sum += static_cast<unsigned>(parseLogLevel(level_str));
+        }
+    });
+    if (chain_sum != hash_sum) {
+        mismatches++;
+    }
+
+    size_t parsed = 0;
+    double line_seconds = measureSeconds([&] {
+        LogEntryView entry;
+        for (const auto& line : lines) {
+            parsed += parseLogLine(line, entry) ? 1 : 0;
+        }
+    });
+    
+    std::string text;
+    for (const auto& line : lines) {
+        text += line;
+        text += '\n';
+    }
+    
+    // Whole-buffer parsing: one find() per line and field vs. block scanning
+    size_t line_loop_parsed = 0;
+    double line_loop_seconds = measureSeconds([&] {
+        std::string_view remaining = text;
+        LogEntryView entry;
+        while (!remaining.empty()) {
+            size_t line_end = remaining.find('\n');
+            line_loop_parsed += parseLogLine(remaining.substr(0, line_end), entry) ? 1 : 0;
+            remaining.remove_prefix(line_end == std::string_view::npos ? remaining.size() : line_end + 1);
+        }
+    });
+    size_t block_parsed = 0;
+    double block_seconds = measureSeconds([&] {
+        parseLogText(text, [&](const LogEntryView&) { block_parsed++; });
+    });
+
+    // The same lines with a thread column after the timestamp
+    std::string thread_text;
+    for (const auto& line : lines) {
+        thread_text.append(line, 0, line.find(FIELD_SEPARATOR) + 1);
+        thread_text += "worker-3";
+        thread_text.append(line, line.find(FIELD_SEPARATOR));
+        thread_text += '\n';
+    }
+    size_t thread_parsed = 0;
+    double thread_seconds = measureSeconds([&] {
+        parseLogText(thread_text, [&](const LogEntryView&) { thread_parsed++; }, LogSchemaId::THREAD);
+    });
+    if (line_loop_parsed != parsed || block_parsed != parsed || thread_parsed != parsed) {
+        mismatches++;
+    }
+    
+    std::printf("%zu lines (README format), %.1f MB\n", lines.size(), text.size() / (1024.0 * 1024.0));
+    report("source info: std::regex", lines.size(), regex_seconds);
+    report("source info: scanner", lines.size(), scanner_seconds);
+    report("level: comparison chain", level_strs.size(), chain_seconds);
+    report("level: perfect hash", level_strs.size(), hash_seconds);
+    report("parseLogLine", parsed, line_seconds);
+    report("buffer: per-line find", line_loop_parsed, line_loop_seconds);
+    std::string block_name = std::string("buffer: block scan (") + separatorScannerName() + ")";
+    report(block_name.c_str(), block_parsed, block_seconds);
+    report("buffer: thread schema", thread_parsed, thread_seconds);
+    std::printf("speedup %.1fx, %zu mismatches\n", regex_seconds / scanner_seconds, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
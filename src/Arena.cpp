@@ -0,0 +1,62 @@
+#include "Arena.hpp"
+#include <algorithm>
+#include <cstring>
+
+Arena::Arena(size_t block_size) : block_size(std::max<size_t>(block_size, 1)) {
+}
+
+Arena::Arena(Arena&& other) noexcept
+    : blocks(std::move(other.blocks)), block_size(other.block_size), cursor(other.cursor),
+      remaining(other.remaining), reserved(other.reserved) {
+    other.blocks.clear();
+    other.cursor = nullptr;
+    other.remaining = 0;
+    other.reserved = 0;
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this != &other) {
+        blocks = std::move(other.blocks);
+        block_size = other.block_size;
+        cursor = other.cursor;
+        remaining = other.remaining;
+        reserved = other.reserved;
+        other.blocks.clear();
+        other.cursor = nullptr;
+        other.remaining = 0;
+        other.reserved = 0;
+    }
+    return *this;
+}
+
+char* Arena::allocate(size_t size) {
+    if (size > remaining) {
+        // Oversized requests get a block of their own
+        size_t new_block_size = std::max(block_size, size);
+        blocks.emplace_back(new char[new_block_size]);
+        cursor = blocks.back().get();
+        remaining = new_block_size;
+        reserved += new_block_size;
+    }
+    char* result = cursor;
+    cursor += size;
+    remaining -= size;
+    return result;
+}
+
+std::string_view Arena::copy(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+    char* data = allocate(text.size());
+    std::memcpy(data, text.data(), text.size());
+    return std::string_view(data, text.size());
+}
+
+void Arena::clear() {
+    blocks.clear();
+    blocks.shrink_to_fit();
+    cursor = nullptr;
+    remaining = 0;
+    reserved = 0;
+}
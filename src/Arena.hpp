@@ -0,0 +1,40 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Bump allocator for entry text. Nothing is freed individually: memory is
+// released all at once by clear() or destruction, and pointers handed out
+// stay valid until then (blocks never move).
+class Arena {
+public:
+    explicit Arena(size_t block_size = 64 * 1024);
+
+    // Moving transfers every block; the source is left empty
+    Arena(Arena&& other) noexcept;
+    Arena& operator=(Arena&& other) noexcept;
+
+    // Uninitialized, unaligned storage for size bytes
+    char* allocate(size_t size);
+
+    // Copy text into the arena
+    std::string_view copy(std::string_view text);
+
+    // Release every block
+    void clear();
+
+    // Total bytes reserved from the system
+    size_t capacity() const { return reserved; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t block_size;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t reserved = 0;
+};
+
+#endif // ARENA_HPP
@@ -0,0 +1,217 @@
+#include "Cli.hpp"
+#include "EntryWriter.hpp"
+#include "FilterIndex.hpp"
+#include "LineParser.hpp"
+#include "LogParser.hpp"
+#include "Query.hpp"
+#include "TimeIndex.hpp"
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct CliOptions {
+    LogFilter filter;
+    OutputFormat format = OutputFormat::TEXT;
+    LogSchemaId schema = LogSchemaId::STANDARD;
+    bool count_only = false;
+    std::vector<std::string> files;
+};
+
+static void printUsage(std::FILE* out) {
+    std::fputs("Usage: log_reader [options] FILE...\n"
+               "Write the entries of each FILE (- for stdin) that pass the filters to stdout.\n"
+               "Without arguments the interactive viewer starts instead.\n"
+               "\n"
+               "  --level LIST    Only these levels, e.g. WARN,ERROR\n"
+               "  --search TEXT   Only messages containing TEXT\n"
+               "  --query QUERY   Only entries matching QUERY, e.g.\n"
+               "                  'level>=WARN AND source:Vulkan.cpp AND msg~\"timeout [0-9]+ms\"'\n"
+               "  --from TIME     Only entries at or after TIME (HH:MM:SS[.fff][+day])\n"
+               "  --to TIME       Only entries before TIME\n"
+               "  --format FMT    text (default) or tsv\n"
+               "  --schema NAME   Field layout of the input: standard (default), thread or frame\n"
+               "  --count         Print the number of matching entries instead\n"
+               "  --help          Show this help\n"
+               "\n"
+               "Exit status is 0 if any entry matched, 1 if none did and 2 on errors.\n", out);
+}
+
+// Parse a comma-separated list of level names into a LogFilter level mask
+static bool parseLevels(std::string_view list, unsigned& mask) {
+    mask = 0;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string name(list.substr(0, comma));
+        for (char& c : name) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        LogLevel level = parseLogLevel(name);
+        if (name != logLevelName(level)) {
+            return false;
+        }
+        mask |= 1u << static_cast<unsigned>(level);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    }
+    return mask != 0;
+}
+
+// Fill options from argv. Returns false with a message on stderr for bad arguments.
+static bool parseArguments(int argc, char* argv[], CliOptions& options, bool& show_help) {
+    bool files_only = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (files_only || arg == "-" || arg.empty() || arg[0] != '-') {
+            options.files.emplace_back(arg);
+            continue;
+        }
+        if (arg == "--") {
+            files_only = true;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h") {
+            show_help = true;
+            return true;
+        }
+        if (arg == "--count") {
+            options.count_only = true;
+            continue;
+        }
+
+        // Everything else takes a value
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "log_reader: %s needs a value\n", argv[i]);
+            return false;
+        }
+        std::string_view value = argv[++i];
+        if (arg == "--level") {
+            if (!parseLevels(value, options.filter.level_mask)) {
+                std::fprintf(stderr, "log_reader: unknown level list '%s'\n", argv[i]);
+                return false;
+            }
+        } else if (arg == "--search") {
+            options.filter.search_term = std::string(value);
+        } else if (arg == "--query") {
+            std::string error;
+            options.filter.query = Query::compile(value, error);
+            if (!options.filter.query) {
+                std::fprintf(stderr, "log_reader: invalid query: %s\n", error.c_str());
+                return false;
+            }
+        } else if (arg == "--from" || arg == "--to") {
+            int64_t clock = TimeIndex::parseClock(value);
+            if (clock < 0) {
+                std::fprintf(stderr, "log_reader: invalid time '%s'\n", argv[i]);
+                return false;
+            }
+            (arg == "--from" ? options.filter.time_from : options.filter.time_to) = clock;
+        } else if (arg == "--format") {
+            if (value == "text") {
+                options.format = OutputFormat::TEXT;
+            } else if (value == "tsv") {
+                options.format = OutputFormat::TSV;
+            } else {
+                std::fprintf(stderr, "log_reader: unknown format '%s'\n", argv[i]);
+                return false;
+            }
+        } else if (arg == "--schema") {
+            if (!parseLogSchemaName(value, options.schema)) {
+                std::fprintf(stderr, "log_reader: unknown schema '%s'\n", argv[i]);
+                return false;
+            }
+        } else {
+            std::fprintf(stderr, "log_reader: unknown option %s\n", argv[i - 1]);
+            return false;
+        }
+    }
+
+    if (options.files.empty()) {
+        std::fputs("log_reader: no input files\n", stderr);
+        return false;
+    }
+    return true;
+}
+
+// Filter one file, counting matches. Returns false if it can't be read.
+static bool filterFile(LogParser& parser, const std::string& path, const CliOptions& options,
+                       OutputBuffer& out, size_t& matched) {
+    // Time ranges follow the viewer's TimeIndex: an entry is in range when
+    // the running maximum of the clock so far is, so the first entry past
+    // the end of the range ends the file
+    const LogFilter& filter = options.filter;
+    int64_t time_from = filter.rangeFrom();
+    int64_t time_to = filter.rangeTo();
+    bool timed = time_from >= 0 || time_to >= 0;
+    int64_t previous_clock = -1;
+    int64_t maximum_clock = 0;
+
+    auto on_entry = [&](const LogEntryView& entry) {
+        if (timed) {
+            int64_t clock = TimeIndex::advance(previous_clock, parseTimeOfDay(entry.timestamp));
+            maximum_clock = clock > maximum_clock ? clock : maximum_clock;
+            if (time_to >= 0 && maximum_clock >= time_to) {
+                return false;
+            }
+            if (maximum_clock < time_from) {
+                return true;
+            }
+        }
+        if (filter.matches(entry)) {
+            matched++;
+            if (!options.count_only) {
+                writeEntry(out, entry, options.format);
+            }
+        }
+        return out.ok();
+    };
+
+    bool read = path == "-" ? parser.parseEntries(std::cin, on_entry) : parser.parseEntries(path, on_entry);
+    if (!read) {
+        std::fprintf(stderr, "log_reader: cannot read %s\n", path.c_str());
+    }
+    return read;
+}
+
+int runCli(int argc, char* argv[]) {
+    CliOptions options;
+    bool show_help = false;
+    if (!parseArguments(argc, argv, options, show_help)) {
+        printUsage(stderr);
+        return 2;
+    }
+    if (show_help) {
+        printUsage(stdout);
+        return 0;
+    }
+
+    LogParser parser;
+    parser.setSchema(options.schema);
+    OutputBuffer out(stdout);
+    size_t total_matched = 0;
+    bool failed = false;
+    for (const std::string& path : options.files) {
+        size_t matched = 0;
+        failed |= !filterFile(parser, path, options, out, matched);
+        total_matched += matched;
+
+        // Counts are per file when there are several, like grep -c
+        if (options.count_only && options.files.size() > 1) {
+            out.append(path);
+            out.append(':');
+            out.append(std::to_string(matched));
+            out.append('\n');
+        }
+        if (!out.ok()) break;
+    }
+    if (options.count_only && options.files.size() == 1) {
+        out.append(std::to_string(total_matched));
+        out.append('\n');
+    }
+
+    if (!out.flush()) {
+        return 2;
+    }
+    return failed ? 2 : (total_matched > 0 ? 0 : 1);
+}
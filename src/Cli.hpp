@@ -0,0 +1,15 @@
+#ifndef CLI_HPP
+#define CLI_HPP
+
+// Headless batch mode: filter log files and write the matching entries to
+// stdout, without the TUI. Entries are streamed through
+// LogParser::parseEntries() and never kept, so memory use doesn't depend on
+// the size of the input.
+//
+//   log_reader [--level WARN,ERROR] [--search TEXT] [--query QUERY] [--from TIME] [--to TIME]
+//              [--format text|tsv] [--schema standard|thread|frame] [--count] FILE...
+//
+// Returns 0 if any entry matched, 1 if none did and 2 on errors, like grep.
+int runCli(int argc, char* argv[]);
+
+#endif // CLI_HPP
@@ -0,0 +1,404 @@
+#include "CompressedFile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+
+#ifdef LOGREADER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef LOGREADER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+// Decompressed bytes per chunk when decompressing sequentially
+static const size_t CHUNK_BYTES = 4 * 1024 * 1024;
+
+// Compressed bytes per group of frames decompressed in parallel
+static const size_t GROUP_BYTES = 1024 * 1024;
+
+static bool isGzipMagic(const unsigned char* data, size_t size) {
+    return size >= 2 && data[0] == 0x1f && data[1] == 0x8b;
+}
+
+static bool isZstdMagic(const unsigned char* data, size_t size) {
+    return size >= 4 && data[0] == 0x28 && data[1] == 0xb5 && data[2] == 0x2f && data[3] == 0xfd;
+}
+
+Compression detectCompression(const std::string& file_path) {
+    std::ifstream file(file_path, std::ios::binary);
+    unsigned char magic[4] = {};
+    file.read(reinterpret_cast<char*>(magic), sizeof(magic));
+    size_t size = static_cast<size_t>(file.gcount());
+    if (isGzipMagic(magic, size)) {
+        return Compression::GZIP;
+    }
+    if (isZstdMagic(magic, size)) {
+        return Compression::ZSTD;
+    }
+    return Compression::NONE;
+}
+
+bool compressionSupported(Compression compression) {
+    switch (compression) {
+#ifdef LOGREADER_HAVE_ZLIB
+        case Compression::GZIP: return true;
+#endif
+#ifdef LOGREADER_HAVE_ZSTD
+        case Compression::ZSTD: return true;
+#endif
+        case Compression::NONE: return true;
+        default:                return false;
+    }
+}
+
+// Size of the BGZF block at data (a gzip member whose "BC" extra field holds
+// its size), or 0 if it isn't one
+static size_t bgzfBlockSize(const unsigned char* data, size_t size) {
+    const size_t HEADER_BYTES = 12;
+    if (size < HEADER_BYTES || !isGzipMagic(data, size) || data[2] != 8 || !(data[3] & 4)) {
+        return 0;
+    }
+    size_t extra_length = data[10] | (data[11] << 8);
+    if (HEADER_BYTES + extra_length > size) {
+        return 0;
+    }
+    for (size_t pos = HEADER_BYTES; pos + 4 <= HEADER_BYTES + extra_length;) {
+        size_t field_length = data[pos + 2] | (data[pos + 3] << 8);
+        if (data[pos] == 'B' && data[pos + 1] == 'C' && field_length == 2 && pos + 6 <= size) {
+            size_t block_size = (data[pos + 4] | (data[pos + 5] << 8)) + 1;
+            return block_size <= size ? block_size : 0;
+        }
+        pos += 4 + field_length;
+    }
+    return 0;
+}
+
+CompressedFile::~CompressedFile() {
+    close();
+}
+
+bool CompressedFile::open(const std::string& file_path, unsigned thread_count) {
+    close();
+    compression = detectCompression(file_path);
+    if (compression == Compression::NONE || !compressionSupported(compression) || !file.open(file_path)) {
+        file.close();
+        return false;
+    }
+
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    findGroups();
+
+    // Set before the threads start so an immediate close() isn't lost
+    stop_requested = false;
+    error = false;
+    if (groups.empty()) {
+        window = 4;
+        workers.emplace_back(&CompressedFile::decompressSequential, this);
+    } else {
+        window = std::max<size_t>(2, thread_count * 2);
+        chunk_count = groups.size();
+        size_t worker_count = std::min<size_t>(thread_count, groups.size());
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back(&CompressedFile::decompressGroups, this);
+        }
+    }
+    return true;
+}
+
+void CompressedFile::close() {
+    {
+        std::lock_guard<std::mutex> lock(chunks_mutex);
+        stop_requested = true;
+    }
+    window_moved.notify_all();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    workers.clear();
+
+    file.close();
+    groups.clear();
+    pending.clear();
+    next_chunk = 0;
+    chunk_count = SIZE_MAX;
+    next_group = 0;
+    consumed = 0;
+}
+
+void CompressedFile::findGroups() {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file.data());
+    size_t size = file.size();
+
+    // Frame boundaries, or none if the input isn't made of independent frames
+    std::vector<Group> frames;
+    for (size_t pos = 0; pos < size;) {
+        size_t frame_size = 0;
+        size_t decompressed_size = 0;
+        if (compression == Compression::GZIP) {
+            frame_size = bgzfBlockSize(data + pos, size - pos);
+            if (frame_size >= 4) {
+                // ISIZE, the member's decompressed size, ends the block
+                const unsigned char* isize = data + pos + frame_size - 4;
+                decompressed_size = isize[0] | (isize[1] << 8) | (isize[2] << 16) | (static_cast<size_t>(isize[3]) << 24);
+            }
+        }
+#ifdef LOGREADER_HAVE_ZSTD
+        if (compression == Compression::ZSTD) {
+            frame_size = ZSTD_findFrameCompressedSize(data + pos, size - pos);
+            if (ZSTD_isError(frame_size)) {
+                frame_size = 0;
+            }
+        }
+#endif
+        if (frame_size == 0) {
+            return;
+        }
+        frames.push_back(Group{pos, frame_size, decompressed_size});
+        pos += frame_size;
+    }
+    if (frames.size() < 2) {
+        return;
+    }
+
+    // Small frames (64 KB for BGZF) are batched so each task is worth a thread
+    for (const Group& frame : frames) {
+        if (groups.empty() || groups.back().size >= GROUP_BYTES) {
+            groups.push_back(frame);
+        } else {
+            groups.back().size += frame.size;
+            groups.back().decompressed_size += frame.decompressed_size;
+        }
+    }
+}
+
+bool CompressedFile::waitForWindow(size_t index) {
+    std::unique_lock<std::mutex> lock(chunks_mutex);
+    window_moved.wait(lock, [&] { return stop_requested || index < next_chunk + window; });
+    return !stop_requested;
+}
+
+void CompressedFile::publish(size_t index, Chunk chunk) {
+    {
+        std::lock_guard<std::mutex> lock(chunks_mutex);
+        size_t slot = index - next_chunk;
+        if (pending.size() <= slot) {
+            pending.resize(slot + 1);
+        }
+        pending[slot] = std::move(chunk);
+    }
+    chunk_ready.notify_all();
+}
+
+void CompressedFile::finish(size_t count, bool failed) {
+    {
+        std::lock_guard<std::mutex> lock(chunks_mutex);
+        if (failed) {
+            error = true;
+        }
+        chunk_count = std::min(chunk_count, count);
+    }
+    chunk_ready.notify_all();
+}
+
+bool CompressedFile::read(std::string& out) {
+    std::optional<Chunk> chunk;
+    {
+        std::unique_lock<std::mutex> lock(chunks_mutex);
+        // Chunks before a corrupt one are still handed out
+        chunk_ready.wait(lock, [&] {
+            return next_chunk >= chunk_count || (!pending.empty() && pending.front().has_value());
+        });
+        if (next_chunk >= chunk_count) {
+            return false;
+        }
+        chunk.swap(pending.front());
+        pending.pop_front();
+        next_chunk++;
+    }
+    window_moved.notify_all();
+
+    out.swap(chunk->data);
+    consumed = chunk->compressed_end;
+    return true;
+}
+
+#ifdef LOGREADER_HAVE_ZLIB
+
+// Inflate gzip members back to back from data into out
+static bool inflateMembers(const unsigned char* data, size_t size, size_t size_hint, std::string& out) {
+    z_stream stream = {};
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return false;
+    }
+    stream.next_in = const_cast<unsigned char*>(data);
+    stream.avail_in = static_cast<uInt>(size);
+
+    out.resize(size_hint ? size_hint : size * 4);
+    size_t produced = 0;
+    bool ok = true;
+    while (ok) {
+        if (out.size() == produced) {
+            out.resize(out.size() * 2);
+        }
+        stream.next_out = reinterpret_cast<unsigned char*>(&out[produced]);
+        stream.avail_out = static_cast<uInt>(out.size() - produced);
+        int result = inflate(&stream, Z_NO_FLUSH);
+        produced = out.size() - stream.avail_out;
+        if (result == Z_STREAM_END) {
+            if (stream.avail_in == 0) break;
+            ok = inflateReset(&stream) == Z_OK;
+        } else if (result != Z_OK && !(result == Z_BUF_ERROR && stream.avail_out == 0)) {
+            ok = false;
+        }
+    }
+    inflateEnd(&stream);
+    out.resize(produced);
+    return ok;
+}
+
+#endif
+
+#ifdef LOGREADER_HAVE_ZSTD
+
+// Decompress zstd frames back to back from data into out
+static bool decompressFrames(ZSTD_DCtx* context, const unsigned char* data, size_t size, std::string& out) {
+    ZSTD_DCtx_reset(context, ZSTD_reset_session_only);
+    unsigned long long content_size = ZSTD_getFrameContentSize(data, size);
+    out.resize(content_size < ZSTD_CONTENTSIZE_ERROR ? static_cast<size_t>(content_size) + 1 : size * 4);
+
+    ZSTD_inBuffer input = {data, size, 0};
+    size_t produced = 0;
+    size_t result = 0;
+    while (input.pos < input.size || result != 0) {
+        if (out.size() == produced) {
+            out.resize(out.size() * 2);
+        }
+        ZSTD_outBuffer output = {&out[0], out.size(), produced};
+        result = ZSTD_decompressStream(context, &output, &input);
+        produced = output.pos;
+        if (ZSTD_isError(result) || (result != 0 && input.pos == input.size && output.pos < output.size)) {
+            return false;
+        }
+    }
+    out.resize(produced);
+    return true;
+}
+
+#endif
+
+void CompressedFile::decompressGroups() {
+    [[maybe_unused]] const unsigned char* data = reinterpret_cast<const unsigned char*>(file.data());
+#ifdef LOGREADER_HAVE_ZSTD
+    ZSTD_DCtx* context = compression == Compression::ZSTD ? ZSTD_createDCtx() : nullptr;
+#endif
+
+    for (size_t g = next_group++; g < groups.size(); g = next_group++) {
+        if (!waitForWindow(g)) break;
+
+        const Group& group = groups[g];
+        Chunk chunk{std::string(), group.offset + group.size};
+        bool ok = false;
+#ifdef LOGREADER_HAVE_ZLIB
+        if (compression == Compression::GZIP) {
+            ok = inflateMembers(data + group.offset, group.size, group.decompressed_size, chunk.data);
+        }
+#endif
+#ifdef LOGREADER_HAVE_ZSTD
+        if (compression == Compression::ZSTD) {
+            ok = context && decompressFrames(context, data + group.offset, group.size, chunk.data);
+        }
+#endif
+        if (!ok) {
+            finish(g, true);
+            break;
+        }
+        publish(g, std::move(chunk));
+    }
+
+#ifdef LOGREADER_HAVE_ZSTD
+    ZSTD_freeDCtx(context);
+#endif
+}
+
+void CompressedFile::decompressSequential() {
+    [[maybe_unused]] const unsigned char* data = reinterpret_cast<const unsigned char*>(file.data());
+    size_t size = file.size();
+    size_t index = 0;
+    bool ok = false;
+
+    // Each full chunk is handed over and decompression continues into a new one
+    Chunk chunk{std::string(CHUNK_BYTES, '\0'), 0};
+    size_t produced = 0;
+    [[maybe_unused]] auto hand_over = [&](size_t compressed_end) {
+        chunk.data.resize(produced);
+        chunk.compressed_end = compressed_end;
+        publish(index++, std::move(chunk));
+        chunk = Chunk{std::string(CHUNK_BYTES, '\0'), 0};
+        produced = 0;
+        return waitForWindow(index);
+    };
+
+#ifdef LOGREADER_HAVE_ZLIB
+    if (compression == Compression::GZIP && waitForWindow(0)) {
+        z_stream stream = {};
+        ok = inflateInit2(&stream, 15 + 16) == Z_OK;
+        size_t input_pos = 0;
+        while (ok) {
+            // zlib counts in 32 bits, so large inputs are fed in pieces
+            if (stream.avail_in == 0 && input_pos < size) {
+                size_t piece = std::min<size_t>(size - input_pos, UINT32_MAX);
+                stream.next_in = const_cast<unsigned char*>(data + input_pos);
+                stream.avail_in = static_cast<uInt>(piece);
+                input_pos += piece;
+            }
+            stream.next_out = reinterpret_cast<unsigned char*>(&chunk.data[produced]);
+            stream.avail_out = static_cast<uInt>(CHUNK_BYTES - produced);
+            int result = inflate(&stream, Z_NO_FLUSH);
+            produced = CHUNK_BYTES - stream.avail_out;
+            size_t compressed_pos = input_pos - stream.avail_in;
+
+            if (result == Z_STREAM_END) {
+                // Another member may follow; anything else after the last one is ignored, as gzip does
+                if (!isGzipMagic(data + compressed_pos, size - compressed_pos)) {
+                    break;
+                }
+                ok = inflateReset(&stream) == Z_OK;
+            } else if (result != Z_OK && !(result == Z_BUF_ERROR && stream.avail_out == 0)) {
+                ok = false;
+            }
+            if (ok && produced == CHUNK_BYTES && !hand_over(compressed_pos)) {
+                break;
+            }
+        }
+        inflateEnd(&stream);
+    }
+#endif
+#ifdef LOGREADER_HAVE_ZSTD
+    if (compression == Compression::ZSTD && waitForWindow(0)) {
+        ZSTD_DCtx* context = ZSTD_createDCtx();
+        ZSTD_inBuffer input = {data, size, 0};
+        size_t result = 0;
+        ok = context != nullptr;
+        while (ok && (input.pos < input.size || result != 0)) {
+            ZSTD_outBuffer output = {&chunk.data[0], CHUNK_BYTES, produced};
+            result = ZSTD_decompressStream(context, &output, &input);
+            produced = output.pos;
+            if (ZSTD_isError(result) || (result != 0 && input.pos == input.size && output.pos < output.size)) {
+                ok = false;
+            } else if (produced == CHUNK_BYTES && !hand_over(input.pos)) {
+                break;
+            }
+        }
+        ZSTD_freeDCtx(context);
+    }
+#endif
+
+    if (ok && produced > 0) {
+        chunk.data.resize(produced);
+        chunk.compressed_end = size;
+        publish(index++, std::move(chunk));
+    }
+    finish(index, !ok && !stop_requested);
+}
@@ -0,0 +1,105 @@
+#ifndef COMPRESSED_FILE_HPP
+#define COMPRESSED_FILE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MappedFile.hpp"
+
+// Formats recognized by their leading magic bytes
+enum class Compression {
+    NONE,
+    GZIP,    // Including multi-member and BGZF files
+    ZSTD,    // Including multi-frame and seekable files
+};
+
+// Compression of the file at file_path, NONE if it isn't compressed or can't be read
+Compression detectCompression(const std::string& file_path);
+
+// Whether this build can decompress the format (zlib and libzstd are optional)
+bool compressionSupported(Compression compression);
+
+// Decompressed contents of a gzip or zstd file, read in order chunk by
+// chunk. Files made of independent frames (BGZF blocks, multi-frame or
+// seekable zstd) are decompressed on a pool of threads, a bounded number of
+// chunks ahead of the reader. Anything else is decompressed on a single
+// background thread, which still overlaps decompression with parsing.
+class CompressedFile {
+public:
+    CompressedFile() = default;
+    ~CompressedFile();
+
+    CompressedFile(const CompressedFile&) = delete;
+    CompressedFile& operator=(const CompressedFile&) = delete;
+
+    // Map file_path and start decompressing. Returns false if it can't be
+    // mapped or isn't in a format this build supports.
+    bool open(const std::string& file_path, unsigned thread_count = 0);
+
+    // Stop the decompression threads and unmap the file
+    void close();
+
+    // Replace out with the next chunk of decompressed bytes. Returns false
+    // at the end of the input or on corrupt data (then failed() is true).
+    bool read(std::string& out);
+
+    bool failed() const { return error.load(std::memory_order_acquire); }
+
+    // Compressed bytes behind the chunks read so far, and in total
+    size_t bytesConsumed() const { return consumed; }
+    size_t size() const { return file.size(); }
+
+private:
+    // Consecutive frames decompressed as one chunk
+    struct Group {
+        size_t offset;
+        size_t size;
+        size_t decompressed_size;   // Exact for BGZF, 0 if not known up front
+    };
+
+    struct Chunk {
+        std::string data;
+        size_t compressed_end;      // File offset the chunk's input ends at
+    };
+
+    MappedFile file;
+    Compression compression = Compression::NONE;
+    std::vector<Group> groups;      // Empty when decompressing sequentially
+    size_t consumed = 0;
+
+    // Chunks from next_chunk on, filled in by the decompression threads
+    std::deque<std::optional<Chunk>> pending;
+    size_t next_chunk = 0;
+    size_t chunk_count = SIZE_MAX;  // Known once the last chunk is published
+    size_t window = 0;              // Chunks that may be decompressed ahead of read()
+    std::mutex chunks_mutex;
+    std::condition_variable chunk_ready;
+    std::condition_variable window_moved;
+
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_group{0};
+    std::atomic<bool> stop_requested{false};
+    std::atomic<bool> error{false};
+
+    // Split the input into independent groups of frames, if it has them
+    void findGroups();
+
+    // Block until chunk index is within the window; false once stopping
+    bool waitForWindow(size_t index);
+    void publish(size_t index, Chunk chunk);
+
+    // Set the chunk count (on errors too, so read() never blocks for good)
+    void finish(size_t count, bool failed);
+
+    void decompressGroups();
+    void decompressSequential();
+};
+
+#endif // COMPRESSED_FILE_HPP
@@ -0,0 +1,248 @@
+#include "DiagnosticLog.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+static const char* const DIAGNOSTIC_FILE = "logreader_debug.log";
+
+// Ring slots (a power of two) and the longest message kept
+static const size_t RING_SLOTS = 1024;
+static const size_t MAX_MESSAGE_BYTES = 480;
+
+// The writer wakes at least this often, and early for errors or a ring
+// that's half full
+static const auto WRITE_INTERVAL = std::chrono::milliseconds(100);
+
+// Bounded multi-producer queue after Dmitry Vyukov's: each slot's sequence
+// says whose turn it is, so producers claim slots with one CAS on the head
+// and the single writer needs no atomic read-modify-writes at all
+struct DiagnosticSlot {
+    std::atomic<size_t> sequence{0};
+    DiagnosticLevel level = DiagnosticLevel::INFO;
+    int64_t time_ms = 0;
+    size_t length = 0;
+    char text[MAX_MESSAGE_BYTES];
+};
+
+class DiagnosticRing {
+public:
+    DiagnosticRing() {
+        for (size_t i = 0; i < RING_SLOTS; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // False if the ring is full
+    bool push(DiagnosticLevel level, int64_t time_ms, std::string_view message) {
+        size_t position = head.load(std::memory_order_relaxed);
+        DiagnosticSlot* slot;
+        while (true) {
+            slot = &slots[position & (RING_SLOTS - 1)];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t turn = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (turn == 0) {
+                if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (turn < 0) {
+                return false;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+        slot->level = level;
+        slot->time_ms = time_ms;
+        slot->length = std::min(message.size(), MAX_MESSAGE_BYTES);
+        std::memcpy(slot->text, message.data(), slot->length);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Writer only: hand the oldest message to visit, false if there's none
+    template <typename Visit>
+    bool pop(Visit&& visit) {
+        DiagnosticSlot& slot = slots[tail & (RING_SLOTS - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+            return false;
+        }
+        visit(slot);
+        slot.sequence.store(tail + RING_SLOTS, std::memory_order_release);
+        tail++;
+        queued_tail.store(tail, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t queued() const {
+        return head.load(std::memory_order_relaxed) - queued_tail.load(std::memory_order_relaxed);
+    }
+
+private:
+    DiagnosticSlot slots[RING_SLOTS];
+    std::atomic<size_t> head{0};
+    size_t tail = 0;
+    std::atomic<size_t> queued_tail{0};   // tail, for producers to see how full the ring is
+};
+
+static DiagnosticRing ring;
+static std::atomic<int> threshold{static_cast<int>(DiagnosticLevel::INFO)};
+static std::atomic<uint64_t> dropped{0};
+
+static std::mutex writer_mutex;         // Starting and stopping the writer
+static std::thread writer;
+static std::atomic<bool> writer_running{false};
+static std::atomic<bool> writer_stop{false};
+static std::atomic<bool> exiting{false};
+static std::mutex wake_mutex;
+static std::condition_variable wake;
+
+static const char* levelName(DiagnosticLevel level) {
+    switch (level) {
+        case DiagnosticLevel::DEBUG: return "DEBUG";
+        case DiagnosticLevel::INFO:  return "INFO";
+        case DiagnosticLevel::WARN:  return "WARN";
+        case DiagnosticLevel::ERROR: return "ERROR";
+        default:                     return "OFF";
+    }
+}
+
+static int64_t wallClockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static void appendLine(std::string& out, DiagnosticLevel level, int64_t time_ms, std::string_view message) {
+    std::time_t seconds = static_cast<std::time_t>(time_ms / 1000);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char prefix[48];
+    std::snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%03d][%s]: ", local.tm_hour, local.tm_min,
+                  local.tm_sec, static_cast<int>(time_ms % 1000), levelName(level));
+    out += prefix;
+    out += message;
+    out += '\n';
+}
+
+// Drain the ring into one buffer and write it with a single call
+static void writeQueued(std::FILE*& file, std::string& buffer) {
+    buffer.clear();
+    while (ring.pop([&](const DiagnosticSlot& slot) {
+        appendLine(buffer, slot.level, slot.time_ms, std::string_view(slot.text, slot.length));
+    })) {
+    }
+    if (uint64_t lost = dropped.exchange(0, std::memory_order_relaxed)) {
+        appendLine(buffer, DiagnosticLevel::WARN, wallClockMs(),
+                   std::to_string(lost) + " diagnostics dropped while the log was full");
+    }
+    if (buffer.empty()) return;
+
+    if (!file) {
+        file = std::fopen(DIAGNOSTIC_FILE, "a");
+        if (!file) return;   // Diagnostics never get in the way of reading logs
+    }
+    std::fwrite(buffer.data(), 1, buffer.size(), file);
+    std::fflush(file);
+}
+
+static void runWriter() {
+    std::FILE* file = nullptr;
+    std::string buffer;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake.wait_for(lock, WRITE_INTERVAL, [] { return writer_stop.load() || ring.queued() >= RING_SLOTS / 2; });
+        }
+        bool stopping = writer_stop.load();
+        writeQueued(file, buffer);
+        if (stopping) break;
+    }
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+static void startWriter() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    if (writer_running) return;
+    writer_stop = false;
+    writer = std::thread(runWriter);
+    writer_running = true;
+}
+
+void setDiagnosticLevel(DiagnosticLevel level) {
+    threshold.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+DiagnosticLevel diagnosticLevel() {
+    return static_cast<DiagnosticLevel>(threshold.load(std::memory_order_relaxed));
+}
+
+bool parseDiagnosticLevel(std::string_view text, DiagnosticLevel& level) {
+    std::string lower(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    const DiagnosticLevel LEVELS[] = {DiagnosticLevel::DEBUG, DiagnosticLevel::INFO, DiagnosticLevel::WARN,
+                                      DiagnosticLevel::ERROR, DiagnosticLevel::OFF};
+    for (DiagnosticLevel candidate : LEVELS) {
+        std::string name = levelName(candidate);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (lower == name) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool diagnosticEnabled(DiagnosticLevel level) {
+    return level != DiagnosticLevel::OFF &&
+           static_cast<int>(level) >= threshold.load(std::memory_order_relaxed);
+}
+
+void logDiagnostic(DiagnosticLevel level, std::string_view message) {
+    if (!diagnosticEnabled(level) || exiting.load(std::memory_order_relaxed)) return;
+    if (!writer_running.load(std::memory_order_acquire)) {
+        startWriter();
+    }
+    if (!ring.push(level, wallClockMs(), message)) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        wake.notify_one();
+        return;
+    }
+    // Errors go out promptly in case the process is about to die
+    if (level == DiagnosticLevel::ERROR || ring.queued() >= RING_SLOTS / 2) {
+        wake.notify_one();
+    }
+}
+
+void stopDiagnostics() {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    if (!writer_running) return;
+    {
+        std::lock_guard<std::mutex> wake_lock(wake_mutex);
+        writer_stop = true;
+    }
+    wake.notify_one();
+    writer.join();
+    writer_running = false;
+}
+
+// Flush whatever is still queued when the program exits; defined last so
+// it's destroyed before the state above
+static struct DiagnosticShutdown {
+    ~DiagnosticShutdown() {
+        exiting = true;
+        stopDiagnostics();
+    }
+} diagnostic_shutdown;
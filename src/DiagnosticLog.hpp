@@ -0,0 +1,38 @@
+#ifndef DIAGNOSTIC_LOG_HPP
+#define DIAGNOSTIC_LOG_HPP
+
+#include <string>
+#include <string_view>
+
+// The reader's own diagnostics, appended to logreader_debug.log. Callers
+// only copy the message into a lock-free ring buffer; a background thread
+// formats and writes whatever has queued up in one batch, so logging never
+// blocks a parsing thread on the disk. When the ring is full, messages are
+// dropped and counted rather than waited on.
+enum class DiagnosticLevel {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    OFF
+};
+
+// Messages below the threshold are discarded; INFO by default
+void setDiagnosticLevel(DiagnosticLevel level);
+DiagnosticLevel diagnosticLevel();
+
+// "debug", "info", "warn", "error" or "off", ignoring case; false otherwise
+bool parseDiagnosticLevel(std::string_view text, DiagnosticLevel& level);
+
+// Check first to skip building messages that would be discarded
+bool diagnosticEnabled(DiagnosticLevel level);
+
+// Queue a message, cut to a few hundred bytes. The writer thread starts
+// with the first message.
+void logDiagnostic(DiagnosticLevel level, std::string_view message);
+
+// Write everything queued so far, then stop the writer. Later messages
+// start it again. Also runs at exit.
+void stopDiagnostics();
+
+#endif // DIAGNOSTIC_LOG_HPP
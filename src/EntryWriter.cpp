@@ -0,0 +1,60 @@
+#include "EntryWriter.hpp"
+#include "LineParser.hpp"
+
+bool OutputBuffer::flush() {
+    if (!buffer.empty() && !failed) {
+        failed = std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size();
+    }
+    buffer.clear();
+    return !failed && std::fflush(file) == 0;
+}
+
+// TSV field with tabs and backslashes escaped so each entry stays one row
+static void appendTsvField(OutputBuffer& out, std::string_view text) {
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\t' && text[i] != '\\') continue;
+        out.append(text.substr(start, i - start));
+        out.append(text[i] == '\t' ? "\\t" : "\\\\");
+        start = i + 1;
+    }
+    out.append(text.substr(start));
+}
+
+void writeEntry(OutputBuffer& out, const LogEntryView& entry, OutputFormat format, std::string_view origin) {
+    std::string line_number = std::to_string(entry.source_line);
+    if (format == OutputFormat::TSV) {
+        if (!origin.empty()) {
+            appendTsvField(out, origin);
+            out.append('\t');
+        }
+        appendTsvField(out, entry.timestamp);
+        out.append('\t');
+        out.append(logLevelName(entry.level));
+        out.append('\t');
+        appendTsvField(out, entry.message);
+        out.append('\t');
+        appendTsvField(out, entry.source_file);
+        out.append('\t');
+        appendTsvField(out, entry.source_function);
+        out.append('\t');
+        out.append(line_number);
+    } else {
+        if (!origin.empty()) {
+            out.append(origin);
+            out.append(": ");
+        }
+        out.append('[');
+        out.append(entry.timestamp);
+        out.append("][");
+        out.append(logLevelName(entry.level));
+        out.append("]: ");
+        out.append(entry.message);
+        out.append(" | ");
+        out.append(entry.source_file);
+        out.append(':');
+        out.append(line_number);
+    }
+    out.append('\n');
+    out.entryDone();
+}
@@ -0,0 +1,51 @@
+#ifndef ENTRY_WRITER_HPP
+#define ENTRY_WRITER_HPP
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "LogEntry.hpp"
+
+enum class OutputFormat {
+    TEXT,    // "[timestamp][LEVEL]: message | file:line", as Copy Filtered writes
+    TSV,     // timestamp, level, message, file, function, line
+};
+
+// Output collected into large writes. Once a write fails (e.g. the reader
+// went away) everything after it is dropped.
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::FILE* file) : file(file) { buffer.reserve(CAPACITY); }
+    ~OutputBuffer() { flush(); }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void append(std::string_view text) { buffer.append(text.data(), text.size()); }
+    void append(char c) { buffer.push_back(c); }
+
+    // Write once enough has been collected
+    void entryDone() {
+        if (buffer.size() >= CAPACITY) {
+            flush();
+        }
+    }
+
+    bool flush();
+
+    bool ok() const { return !failed; }
+
+private:
+    static constexpr size_t CAPACITY = 1024 * 1024;
+
+    std::FILE* file;
+    std::string buffer;
+    bool failed = false;
+};
+
+// Write entry as one line. A non-empty origin (the file of a merged view's
+// row) is written first as "origin: ".
+void writeEntry(OutputBuffer& out, const LogEntryView& entry, OutputFormat format,
+                std::string_view origin = {});
+
+#endif // ENTRY_WRITER_HPP
@@ -0,0 +1,133 @@
+#include "ExportWorker.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+// Between progress messages, and between polls of a running search
+static const auto PROGRESS_INTERVAL = std::chrono::milliseconds(100);
+static const auto SEARCH_POLL = std::chrono::milliseconds(10);
+
+// Rows written between checks for cancellation
+static const size_t CANCEL_CHECK_ROWS = 4096;
+
+ExportWorker::~ExportWorker() {
+    cancel();
+}
+
+const char* ExportWorker::clipboardCommand() {
+#if defined(_WIN32)
+    return "clip";
+#elif defined(__APPLE__)
+    return "pbcopy";
+#else
+    // xsel only runs, reading the untouched input, if xclip can't start
+    return "xclip -selection clipboard 2>/dev/null || xsel --clipboard --input 2>/dev/null";
+#endif
+}
+
+void ExportWorker::start(const LogStore& store, const LogFilter& filter, ExportTarget target,
+                         const std::string& path, OutputFormat format, ProgressCallback on_progress) {
+    cancel();
+
+    // Set before the thread starts so an immediate cancel() isn't lost
+    stop_requested = false;
+    running = true;
+    export_thread = std::thread(&ExportWorker::run, this, std::cref(store), filter, target, path, format,
+                                std::move(on_progress));
+}
+
+void ExportWorker::cancel() {
+    stop_requested = true;
+    if (export_thread.joinable()) {
+        export_thread.join();
+    }
+}
+
+void ExportWorker::run(const LogStore& store, LogFilter filter, ExportTarget target, std::string path,
+                       OutputFormat format, ProgressCallback on_progress) {
+    const bool to_clipboard = target == ExportTarget::CLIPBOARD;
+    std::FILE* file = nullptr;
+    if (to_clipboard) {
+#ifndef _WIN32
+        // A clipboard tool that exits early must fail the write, not kill the viewer
+        std::signal(SIGPIPE, SIG_IGN);
+#endif
+        file = popen(clipboardCommand(), "w");
+    } else {
+        file = std::fopen(path.c_str(), "wb");
+    }
+    if (!file) {
+        on_progress(to_clipboard ? "Error: Could not start the clipboard command" : "Error: Could not create " + path);
+        running = false;
+        return;
+    }
+
+    // Merged views name each row's file. Network streams add hosts while
+    // the export runs, so names are taken up as rows with new origins come;
+    // a row's origin is always published before the row is.
+    std::vector<std::string> origins;
+    auto origin_name = [&](size_t row) -> std::string_view {
+        if (!store.isMerged()) {
+            return {};
+        }
+        uint16_t origin = store.origin(row);
+        while (origins.size() <= origin) {
+            origins.push_back(std::filesystem::path(store.originName(origins.size())).filename().string());
+        }
+        return origins[origin];
+    };
+
+    // Rows are written as the search finds them; they arrive in order
+    FilterIndex index;
+    size_t written = 0;
+    bool write_failed = false;
+    auto last_progress = std::chrono::steady_clock::now();
+    {
+        OutputBuffer out(file);
+        index.update(store, filter);
+        while (true) {
+            // Matches published before a finished search are all in size()
+            bool searching = index.searching();
+            index.update(store, filter);
+            size_t available = index.size();
+
+            for (; written < available; ++written) {
+                if (written % CANCEL_CHECK_ROWS == 0) {
+                    if (stop_requested || !out.ok()) break;
+                    auto now = std::chrono::steady_clock::now();
+                    if (now - last_progress >= PROGRESS_INTERVAL) {
+                        last_progress = now;
+                        std::string done = std::to_string(written) + " entries";
+                        on_progress(searching ? "Exporting... " + done + " (searching)"
+                                              : "Exporting... " + done + " of " + std::to_string(available));
+                    }
+                }
+                size_t row = index[written];
+                writeEntry(out, store[row], format, origin_name(row));
+            }
+            write_failed = !out.flush();
+            if (!searching || stop_requested || write_failed) break;
+            std::this_thread::sleep_for(SEARCH_POLL);
+        }
+    }
+    index.cancel();
+
+    bool close_failed = to_clipboard ? pclose(file) != 0 : std::fclose(file) != 0;
+    std::string count = std::to_string(written) + " entries";
+    if (stop_requested) {
+        on_progress("Export cancelled after " + count);
+    } else if (write_failed || close_failed) {
+        on_progress(to_clipboard ? "Error: Clipboard command failed (is xclip or xsel installed?)"
+                                 : "Error: Could not write " + path);
+    } else {
+        on_progress(to_clipboard ? "Copied " + count + " to clipboard" : "Exported " + count + " to " + path);
+    }
+    running = false;
+}
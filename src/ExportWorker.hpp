@@ -0,0 +1,54 @@
+#ifndef EXPORT_WORKER_HPP
+#define EXPORT_WORKER_HPP
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include "EntryWriter.hpp"
+#include "FilterIndex.hpp"
+#include "LogStore.hpp"
+
+// Where an export goes
+enum class ExportTarget {
+    FILE,         // The path given to start()
+    CLIPBOARD,    // Piped to the platform's clipboard command
+};
+
+// Background export of the entries passing a filter. The worker keeps its
+// own FilterIndex over the store, so the viewer's index is never read from
+// another thread, and streams rows from it straight into the output a
+// buffer at a time; nothing proportional to the export is held in memory.
+// start() and cancel() must come from the same thread, and the store must
+// outlive the export (cancel() before clearing it).
+class ExportWorker {
+public:
+    using ProgressCallback = std::function<void(const std::string&)>;
+
+    ~ExportWorker();
+
+    // Cancel any running export and start writing the store's entries
+    // passing filter to target (path is used for FILE). on_progress is
+    // called from the worker with status messages, the last one saying
+    // how the export ended.
+    void start(const LogStore& store, const LogFilter& filter, ExportTarget target, const std::string& path,
+               OutputFormat format, ProgressCallback on_progress);
+
+    // Stop the running export and wait for it; a partial file is left behind
+    void cancel();
+
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Shell command a CLIPBOARD export writes to
+    static const char* clipboardCommand();
+
+private:
+    std::thread export_thread;
+    std::atomic<bool> stop_requested{false};
+    std::atomic<bool> running{false};
+
+    void run(const LogStore& store, LogFilter filter, ExportTarget target, std::string path,
+             OutputFormat format, ProgressCallback on_progress);
+};
+
+#endif // EXPORT_WORKER_HPP
@@ -0,0 +1,306 @@
+#include "FileFollower.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+#include <chrono>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#undef ERROR
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#include <sys/event.h>
+#define FOLLOW_KQUEUE
+#endif
+#endif
+
+// Directory holding path, watched so renames and re-creation are seen too
+static std::filesystem::path parentDirectory(const std::string& file_path) {
+    std::filesystem::path directory = std::filesystem::path(file_path).parent_path();
+    return directory.empty() ? std::filesystem::path(".") : directory;
+}
+
+FileFollower::~FileFollower() {
+    close();
+}
+
+bool FileFollower::open(const std::string& file_path, size_t offset) {
+    close();
+    path = file_path;
+    if (!openFile()) {
+        return false;
+    }
+    read_offset = offset;
+    watch();
+    return true;
+}
+
+#ifdef _WIN32
+
+// Volume serial and file index, unique per file while it exists
+static bool fileIdentity(HANDLE file, uint64_t& volume, uint64_t& index) {
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle(file, &info)) {
+        return false;
+    }
+    volume = info.dwVolumeSerialNumber;
+    index = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    return true;
+}
+
+// Identity of whatever file_path names now; false if nothing does
+static bool pathIdentity(const std::string& file_path, uint64_t& volume, uint64_t& index) {
+    std::filesystem::path path(file_path);
+    HANDLE file = CreateFileW(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, 0, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool found = fileIdentity(file, volume, index);
+    CloseHandle(file);
+    return found;
+}
+
+bool FileFollower::openFile() {
+    // Share everything so the writer can keep appending, truncating and renaming
+    std::filesystem::path file_path(path);
+    HANDLE file = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, 0, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    if (!fileIdentity(file, file_volume, file_index)) {
+        CloseHandle(file);
+        return false;
+    }
+    file_handle = file;
+    return true;
+}
+
+void FileFollower::closeFile() {
+    if (file_handle) {
+        CloseHandle(file_handle);
+    }
+    file_handle = nullptr;
+}
+
+void FileFollower::watch() {
+    std::filesystem::path directory = parentDirectory(path);
+    HANDLE change = FindFirstChangeNotificationW(directory.c_str(), FALSE,
+        FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    change_handle = change == INVALID_HANDLE_VALUE ? nullptr : change;
+}
+
+void FileFollower::close() {
+    closeFile();
+    if (change_handle) {
+        FindCloseChangeNotification(change_handle);
+    }
+    change_handle = nullptr;
+}
+
+void FileFollower::wait(int timeout_ms) {
+    if (!change_handle) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return;
+    }
+    if (WaitForSingleObject(change_handle, static_cast<DWORD>(timeout_ms)) == WAIT_OBJECT_0) {
+        FindNextChangeNotification(change_handle);
+    }
+}
+
+FileFollower::Change FileFollower::read(std::string& out) {
+    // A replacement that couldn't be opened yet is retried on every read
+    if (!file_handle && !openFile()) {
+        return Change::NONE;
+    }
+
+    uint64_t volume, index;
+    bool replaced = pathIdentity(path, volume, index) && (volume != file_volume || index != file_index);
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        return Change::NONE;
+    }
+    size_t size = static_cast<size_t>(file_size.QuadPart);
+    if (!replaced && size < read_offset) {
+        read_offset = 0;
+        return Change::TRUNCATED;
+    }
+
+    // Drain what's left of the open file before switching to a replacement
+    if (size > read_offset) {
+        size_t length = std::min(size - read_offset, MAX_READ);
+        size_t start = out.size();
+        out.resize(start + length);
+        OVERLAPPED position = {};
+        position.Offset = static_cast<DWORD>(read_offset);
+        position.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(read_offset) >> 32);
+        DWORD bytes_read = 0;
+        if (!ReadFile(file_handle, &out[start], static_cast<DWORD>(length), &bytes_read, &position)) {
+            bytes_read = 0;
+        }
+        out.resize(start + bytes_read);
+        read_offset += bytes_read;
+        if (bytes_read > 0) {
+            return Change::APPENDED;
+        }
+    }
+
+    if (replaced) {
+        closeFile();
+        read_offset = 0;
+        openFile();
+        return Change::ROTATED;
+    }
+    return Change::NONE;
+}
+
+#else
+
+bool FileFollower::openFile() {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Only regular files have an end to follow
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    file_descriptor = fd;
+    file_volume = static_cast<uint64_t>(file_stat.st_dev);
+    file_index = static_cast<uint64_t>(file_stat.st_ino);
+    return true;
+}
+
+void FileFollower::closeFile() {
+    if (file_descriptor >= 0) {
+        ::close(file_descriptor);
+    }
+    file_descriptor = -1;
+}
+
+void FileFollower::watch() {
+#if defined(__linux__)
+    if (notify_descriptor < 0) {
+        notify_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notify_descriptor < 0) return;
+        std::string directory = parentDirectory(path).string();
+        if (inotify_add_watch(notify_descriptor, directory.c_str(),
+                              IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                              IN_MOVED_FROM | IN_MOVED_TO) < 0) {
+            ::close(notify_descriptor);
+            notify_descriptor = -1;
+        }
+    }
+#elif defined(FOLLOW_KQUEUE)
+    // kqueue watches the open file itself, so re-register after rotation
+    if (notify_descriptor < 0) {
+        notify_descriptor = kqueue();
+        if (notify_descriptor < 0) return;
+    }
+    struct kevent change;
+    EV_SET(&change, file_descriptor, EVFILT_VNODE, EV_ADD | EV_CLEAR,
+           NOTE_WRITE | NOTE_EXTEND | NOTE_ATTRIB | NOTE_DELETE | NOTE_RENAME, 0, nullptr);
+    if (kevent(notify_descriptor, &change, 1, nullptr, 0, nullptr) < 0) {
+        ::close(notify_descriptor);
+        notify_descriptor = -1;
+    }
+#endif
+}
+
+void FileFollower::close() {
+    closeFile();
+    if (notify_descriptor >= 0) {
+        ::close(notify_descriptor);
+    }
+    notify_descriptor = -1;
+}
+
+void FileFollower::wait(int timeout_ms) {
+#if defined(__linux__)
+    if (notify_descriptor >= 0) {
+        pollfd watched = {notify_descriptor, POLLIN, 0};
+        if (poll(&watched, 1, timeout_ms) > 0) {
+            // Only the wake-up matters; read() rechecks the file itself
+            char events[4096];
+            while (::read(notify_descriptor, events, sizeof(events)) > 0) {
+            }
+        }
+        return;
+    }
+#elif defined(FOLLOW_KQUEUE)
+    if (notify_descriptor >= 0) {
+        struct kevent event;
+        timespec timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+        kevent(notify_descriptor, nullptr, 0, &event, 1, &timeout);
+        return;
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+}
+
+FileFollower::Change FileFollower::read(std::string& out) {
+    // A replacement that couldn't be opened yet is retried on every read
+    if (file_descriptor < 0) {
+        if (!openFile()) {
+            return Change::NONE;
+        }
+        watch();
+    }
+
+    // The path naming a different file means the one we hold was rotated away
+    struct stat path_stat;
+    bool replaced = ::stat(path.c_str(), &path_stat) == 0 &&
+                    (static_cast<uint64_t>(path_stat.st_dev) != file_volume ||
+                     static_cast<uint64_t>(path_stat.st_ino) != file_index);
+
+    struct stat file_stat;
+    if (fstat(file_descriptor, &file_stat) != 0) {
+        return Change::NONE;
+    }
+    size_t size = static_cast<size_t>(file_stat.st_size);
+    if (!replaced && size < read_offset) {
+        read_offset = 0;
+        return Change::TRUNCATED;
+    }
+
+    // Drain what's left of the open file before switching to a replacement
+    if (size > read_offset) {
+        size_t length = std::min(size - read_offset, MAX_READ);
+        size_t start = out.size();
+        out.resize(start + length);
+        ssize_t bytes_read = pread(file_descriptor, &out[start], length, static_cast<off_t>(read_offset));
+        if (bytes_read < 0) {
+            bytes_read = 0;
+        }
+        out.resize(start + static_cast<size_t>(bytes_read));
+        read_offset += static_cast<size_t>(bytes_read);
+        if (bytes_read > 0) {
+            return Change::APPENDED;
+        }
+    }
+
+    if (replaced) {
+        closeFile();
+        read_offset = 0;
+        if (openFile()) {
+            watch();
+        }
+        return Change::ROTATED;
+    }
+    return Change::NONE;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef FILE_FOLLOWER_HPP
+#define FILE_FOLLOWER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Reads bytes appended to a file that another process keeps writing, like
+// `tail -F`. Changes are waited for with inotify (Linux), kqueue (macOS and
+// BSD) or directory change notifications (Windows), and by polling when
+// none of those is available. The path is rechecked on every read, so a
+// truncated file is followed from its start and a rotated one (renamed
+// away and recreated) is drained and then replaced by the new file.
+class FileFollower {
+public:
+    enum class Change {
+        NONE,        // Nothing new
+        APPENDED,    // Bytes were read
+        TRUNCATED,   // The file shrank; reading restarts at offset 0
+        ROTATED,     // The path names a new file; reading restarts at offset 0
+    };
+
+    FileFollower() = default;
+    ~FileFollower();
+
+    FileFollower(const FileFollower&) = delete;
+    FileFollower& operator=(const FileFollower&) = delete;
+
+    // Start following file_path from offset. Returns false if it can't be opened.
+    bool open(const std::string& file_path, size_t offset);
+    void close();
+
+    // Block until the file may have changed, or for at most timeout_ms
+    void wait(int timeout_ms);
+
+    // Append up to MAX_READ new bytes to out. Truncation and rotation are
+    // reported on their own, before any bytes of the new contents are read.
+    Change read(std::string& out);
+
+    size_t offset() const { return read_offset; }
+
+private:
+    static constexpr size_t MAX_READ = 16 * 1024 * 1024;
+
+    std::string path;
+    size_t read_offset = 0;
+    uint64_t file_volume = 0;     // Identity of the open file, to spot rotation
+    uint64_t file_index = 0;
+
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* change_handle = nullptr;
+#else
+    int file_descriptor = -1;
+    int notify_descriptor = -1;   // inotify or kqueue
+#endif
+
+    bool openFile();
+    void closeFile();
+    void watch();
+};
+
+#endif // FILE_FOLLOWER_HPP
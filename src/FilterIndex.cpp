@@ -0,0 +1,227 @@
+#include "FilterIndex.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+
+bool LogFilter::matches(const LogStore& store, size_t index) const {
+    // Apply level filters
+    if (level_mask != 0 && !((level_mask >> static_cast<unsigned>(store.level(index))) & 1u)) {
+        return false;
+    }
+    
+    // Apply time range
+    const TimeIndex& clocks = store.timeIndex();
+    int64_t from = rangeFrom();
+    int64_t to = rangeTo();
+    if ((from >= 0 && index < clocks.seek(from, store.size())) ||
+        (to >= 0 && index >= clocks.seek(to, store.size()))) {
+        return false;
+    }
+    
+    // Apply search filter
+    if (!search_term.empty() && store.message(index).find(search_term) == std::string_view::npos) {
+        return false;
+    }
+    return !query || query->matches(store, index);
+}
+
+bool LogFilter::matches(const LogEntryView& entry) const {
+    if (level_mask != 0 && !((level_mask >> static_cast<unsigned>(entry.level)) & 1u)) {
+        return false;
+    }
+    if (!search_term.empty() && entry.message.find(search_term) == std::string_view::npos) {
+        return false;
+    }
+    return !query || query->matches(entry);
+}
+
+int64_t LogFilter::rangeFrom() const {
+    return query ? std::max(time_from, query->timeFrom()) : time_from;
+}
+
+int64_t LogFilter::rangeTo() const {
+    int64_t query_to = query ? query->timeTo() : -1;
+    if (time_to < 0 || query_to < 0) {
+        return std::max(time_to, query_to);
+    }
+    return std::min(time_to, query_to);
+}
+
+void FilterIndex::update(const LogStore& new_store, const LogFilter& new_filter) {
+    StageTimer timer(MetricStage::FILTER);
+    size_t total = new_store.size();
+    bool rebuild = !built || new_filter != filter || &new_store != store || new_store.generation() != store_generation;
+    if (rebuild) {
+        filter = new_filter;
+        store = &new_store;
+        store_generation = new_store.generation();
+        level_mask = filter.level_mask != 0 ? filter.level_mask : LevelIndex::ALL_LEVELS;
+        if (filter.query) {
+            level_mask &= filter.query->levelMask();
+        }
+        level_rows = 0;
+        rows.clear();
+        scanned = 0;
+        caught_up = 0;
+        built = true;
+    }
+    
+    // Rows of the time range. Appended rows can only move an end that
+    // hadn't been reached yet, so rows already matched stay valid.
+    const TimeIndex& clocks = store->timeIndex();
+    int64_t from = filter.rangeFrom();
+    int64_t to = filter.rangeTo();
+    first_row = from >= 0 ? clocks.seek(from, total) : 0;
+    end_row = to >= 0 ? std::max(first_row, clocks.seek(to, total)) : total;
+    
+    if (rebuild) {
+        if (!filter.readsRows()) {
+            search.cancel();
+        } else if (filter.query || !searchIndexed()) {
+            // Hand the rows loaded so far to the background search
+            search.start(*store, level_mask, filter.search_term, filter.query, first_row, end_row, on_progress);
+            scanned = end_row;
+        }
+    }
+    
+    const LevelIndex& levels = store->levelIndex();
+    if (!filter.readsRows()) {
+        level_skipped = levels.count(level_mask, first_row);
+        level_rows = levels.count(level_mask, end_row) - level_skipped;
+        scanned = end_row;
+    } else if (!search.isRunning()) {
+        // Only entries appended since the last update need testing
+        levels.forEachRow(level_mask, std::max(scanned, first_row), end_row, [&](size_t row) {
+            if ((filter.search_term.empty() || store->message(row).find(filter.search_term) != std::string_view::npos) &&
+                (!filter.query || filter.query->matches(*store, row))) {
+                rows.push_back(row);
+            }
+        });
+        scanned = std::max(scanned, end_row);
+    }
+    
+    // Rows past end_row are outside the time range
+    if (!search.isRunning()) {
+        caught_up = total;
+    }
+}
+
+bool FilterIndex::searchIndexed() {
+    if (!trigram_index || !trigram_index->isReady() || trigram_index->generation() != store->generation()) {
+        return false;
+    }
+    std::vector<size_t> candidates;
+    if (!trigram_index->candidates(filter.search_term, candidates)) {
+        return false;
+    }
+    
+    // Candidates contain every trigram of the term; confirm the real match
+    search.clear();
+    scanned = std::min(trigram_index->rows(), end_row);
+    for (size_t row : candidates) {
+        if (row >= first_row && row < scanned && ((level_mask >> static_cast<unsigned>(store->level(row))) & 1u) &&
+            store->message(row).find(filter.search_term) != std::string_view::npos) {
+            rows.push_back(row);
+        }
+    }
+    return true;
+}
+
+void FilterIndex::cancel() {
+    search.cancel();
+    built = false;
+}
+
+void FilterIndex::wait() {
+    search.wait();
+}
+
+size_t FilterIndex::size() const {
+    if (!filter.readsRows()) {
+        return level_rows;
+    }
+    // rows stays empty while the worker runs, so this is always a prefix
+    return search.size() + rows.size();
+}
+
+size_t FilterIndex::operator[](size_t position) const {
+    if (!filter.readsRows()) {
+        return store->levelIndex().select(level_mask, level_skipped + position, end_row);
+    }
+    size_t found = search.size();
+    return position < found ? search[position] : rows[position - found];
+}
+
+size_t FilterIndex::lowerBound(size_t row) const {
+    if (!filter.readsRows()) {
+        row = std::min(std::max(row, first_row), end_row);
+        return store->levelIndex().count(level_mask, row) - level_skipped;
+    }
+    
+    // Matches are in row order
+    size_t low = 0;
+    size_t high = size();
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if ((*this)[middle] < row) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+size_t FilterIndex::nextOfLevel(size_t position, LogLevel level) const {
+    size_t total = size();
+    unsigned mask = level_mask & (1u << static_cast<unsigned>(level));
+    if (mask == 0 || position + 1 >= total) {
+        return total;
+    }
+    
+    // Intersect the filtered rows with the level's rows by leapfrogging:
+    // each side jumps to the other's next candidate, so this touches no
+    // more rows than the smaller of the two sets holds before the match.
+    // With a level-only filter the first jump lands.
+    const LevelIndex& levels = store->levelIndex();
+    size_t end = (*this)[total - 1] + 1;
+    size_t last = levels.count(mask, end);
+    size_t found = position + 1;
+    while (found < total) {
+        size_t row = (*this)[found];
+        size_t k = levels.count(mask, row);
+        if (k >= last) {
+            break;
+        }
+        size_t level_row = levels.select(mask, k, end);
+        if (level_row == row) {
+            return found;
+        }
+        found = lowerBound(level_row);
+    }
+    return total;
+}
+
+size_t FilterIndex::previousOfLevel(size_t position, LogLevel level) const {
+    size_t total = size();
+    unsigned mask = level_mask & (1u << static_cast<unsigned>(level));
+    if (mask == 0 || position == 0 || position > total) {
+        return total;
+    }
+    
+    // The same leapfrog backwards, over the positions before found
+    const LevelIndex& levels = store->levelIndex();
+    size_t found = position;
+    while (found > 0) {
+        size_t row = (*this)[found - 1];
+        size_t k = levels.count(mask, row + 1);
+        if (k == 0) {
+            break;
+        }
+        size_t level_row = levels.select(mask, k - 1, row + 1);
+        if (level_row == row) {
+            return found - 1;
+        }
+        found = lowerBound(level_row + 1);
+    }
+    return total;
+}
@@ -0,0 +1,113 @@
+#ifndef FILTER_INDEX_HPP
+#define FILTER_INDEX_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "LogStore.hpp"
+#include "Query.hpp"
+#include "SearchWorker.hpp"
+#include "TrigramIndex.hpp"
+
+// Level, search and time criteria applied by the viewer
+struct LogFilter {
+    unsigned level_mask = 0;     // Bit per LogLevel; 0 shows every level
+    std::string search_term;     // Substring of the message; empty matches all
+    int64_t time_from = -1;      // TimeIndex clocks of the rows shown, [from, to);
+    int64_t time_to = -1;        // -1 leaves that end open
+    std::shared_ptr<const Query> query;   // Structured query on top of the rest, or null
+
+    bool matches(const LogStore& store, size_t index) const;
+
+    // Level, search and query criteria only, for entries that aren't in a
+    // store (the query's time range included in rangeFrom()/rangeTo())
+    bool matches(const LogEntryView& entry) const;
+
+    // The time range with the query's narrowing it
+    int64_t rangeFrom() const;
+    int64_t rangeTo() const;
+
+    // Whether rows have to be read, not just counted from the level index
+    bool readsRows() const { return !search_term.empty() || query; }
+
+    bool operator==(const LogFilter& other) const {
+        return level_mask == other.level_mask && search_term == other.search_term &&
+               time_from == other.time_from && time_to == other.time_to &&
+               (query ? query->text() : std::string()) == (other.query ? other.query->text() : std::string());
+    }
+    bool operator!=(const LogFilter& other) const { return !(*this == other); }
+};
+
+// Cached indices of the store entries passing a LogFilter. Level-only
+// filters are answered straight from the store's LevelIndex, so toggling
+// levels costs nothing however large the file is. A new search term is
+// answered from a ready TrigramIndex when one covers the store, verifying
+// only its candidate rows; otherwise it starts a SearchWorker over the
+// rows loaded so far, and matches show up in the index as they are found.
+// Queries narrow the level mask and time range first and are always
+// tested by a SearchWorker.
+// After that, update() just tests entries appended since the last call,
+// reading only the messages of rows whose level passes. A time range is
+// turned into a range of rows by seeking the store's TimeIndex.
+class FilterIndex {
+public:
+    // Bring the index up to date with the store's published entries
+    void update(const LogStore& store, const LogFilter& filter);
+
+    // Stop any background search; the next update() starts over. Call
+    // before clearing the store.
+    void cancel();
+
+    // Block until a background search has finished
+    void wait();
+
+    bool searching() const { return search.isRunning(); }
+
+    // Called from the search thread when new matches are available
+    void setProgressCallback(std::function<void()> callback) { on_progress = std::move(callback); }
+
+    // Trigram index to consult for new search terms, or nullptr
+    void setTrigramIndex(const TrigramIndex* index) { trigram_index = index; }
+
+    size_t size() const;
+
+    // Store rows the index has caught up with: every row before it has
+    // been tested, or is outside the time range. Behind the store's size
+    // while a search or query is still scanning.
+    size_t scannedRows() const { return search.isRunning() ? search.searchedTo() : caught_up; }
+    size_t operator[](size_t position) const;
+
+    // Position of the first entry at or after store row, size() if none
+    size_t lowerBound(size_t row) const;
+
+    // Position of the nearest entry of level after or before position,
+    // size() if none. The filtered rows are intersected with the level
+    // index, jumping between the two, so rows in between are never read
+    // and the steps are bounded by the sparser of the two.
+    size_t nextOfLevel(size_t position, LogLevel level) const;
+    size_t previousOfLevel(size_t position, LogLevel level) const;
+
+private:
+    SearchWorker search;              // Matches among the first search_rows rows
+    std::function<void()> on_progress;
+    const TrigramIndex* trigram_index = nullptr;
+    LogFilter filter;
+    const LogStore* store = nullptr;
+    unsigned level_mask = 0;          // filter.level_mask with 0 meaning every level
+    size_t level_rows = 0;            // Matches among the first scanned rows, level-only filters
+    size_t level_skipped = 0;         // Level matches before first_row
+    size_t first_row = 0;             // Store rows in the filter's time range, [first_row, end_row)
+    size_t end_row = 0;
+    std::vector<size_t> rows;         // Search matches after those from the worker
+    size_t scanned = 0;               // Store entries already tested
+    size_t caught_up = 0;             // scannedRows() once no search is running
+    uint64_t store_generation = 0;    // LogStore::generation() the index was built from
+    bool built = false;
+
+    // Fill rows from the trigram index; false if it can't answer the search
+    bool searchIndexed();
+};
+
+#endif // FILTER_INDEX_HPP
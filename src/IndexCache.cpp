@@ -0,0 +1,342 @@
+#include "IndexCache.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+static const char INDEX_MAGIC[8] = {'L', 'R', 'I', 'N', 'D', 'E', 'X', '\0'};
+static const uint32_t INDEX_VERSION = 2;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+// Bytes hashed at each end of the covered range to detect rewritten files
+static const size_t EDGE_BYTES = 4096;
+
+// Strings outside the log (parser literals such as "unknown") are kept in a
+// blob after the header; their refs have this bit set
+static const uint64_t LITERAL_BIT = uint64_t(1) << 63;
+
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;            // Log size and mtime when written
+    int64_t file_mtime;
+    uint64_t covered_bytes;        // Whole lines the rows were parsed from
+    uint64_t line_count;
+    uint64_t row_count;
+    uint64_t source_file_count;
+    uint64_t source_function_count;
+    uint64_t literal_bytes;
+    uint64_t edge_hash;
+    uint64_t schema;               // LogSchemaId the rows were parsed with
+};
+
+struct StringRef {
+    uint64_t ref;                  // Offset into the log, or LITERAL_BIT | blob offset
+    uint64_t length;
+};
+
+// Timestamp and message of one row, both inside the log
+struct RowText {
+    uint64_t timestamp_offset;
+    uint32_t timestamp_length;
+    uint32_t message_delta;        // Message offset - timestamp offset
+    uint32_t message_length;
+};
+
+// Section layout after the header, in file order
+static size_t padded(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+static size_t indexSize(const IndexHeader& header) {
+    size_t rows = static_cast<size_t>(header.row_count);
+    return sizeof(IndexHeader) + padded(static_cast<size_t>(header.literal_bytes)) +
+           static_cast<size_t>(header.source_file_count + header.source_function_count) * sizeof(StringRef) +
+           rows * sizeof(RowText) +
+           rows * sizeof(int32_t) +            // times
+           padded(rows) +                      // levels
+           rows * sizeof(uint32_t) * 2 +       // source file and function ids
+           rows * sizeof(int32_t);             // source lines
+}
+
+static uint64_t fnv1a(std::string_view bytes, uint64_t hash = 1469598103934665603ull) {
+    for (unsigned char c : bytes) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t edgeHash(std::string_view text, size_t covered) {
+    size_t head = std::min(covered, EDGE_BYTES);
+    size_t tail = std::min(covered, EDGE_BYTES);
+    return fnv1a(text.substr(covered - tail, tail), fnv1a(text.substr(0, head)));
+}
+
+static int64_t modificationTime(const std::string& file_path) {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(file_path, error);
+    return error ? 0 : static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+std::string indexCachePath(const std::string& file_path) {
+    return file_path + ".lrindex";
+}
+
+// Reads fixed-size records out of the mapped cache without alignment assumptions
+class IndexReader {
+public:
+    explicit IndexReader(std::string_view bytes) : bytes(bytes) {}
+
+    template <typename T>
+    T read(size_t index = 0) const {
+        T value;
+        std::memcpy(&value, bytes.data() + position + index * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    std::string_view take(size_t size) {
+        std::string_view section = bytes.substr(position, size);
+        position += size;
+        return section;
+    }
+    void skip(size_t size) { position += size; }
+
+private:
+    std::string_view bytes;
+    size_t position = 0;
+};
+
+size_t loadIndexCache(const std::string& file_path, LogStore& store, size_t& line_count) {
+    MappedFile cache;
+    if (!cache.open(indexCachePath(file_path)) || cache.size() < sizeof(IndexHeader)) {
+        return 0;
+    }
+    std::string_view bytes = cache.view();
+    std::string_view text = store.text();
+
+    IndexHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header.version != INDEX_VERSION ||
+        header.byte_order != BYTE_ORDER_MARK || indexSize(header) != bytes.size() ||
+        header.schema != static_cast<uint64_t>(store.schema())) {
+        return 0;
+    }
+
+    // Unchanged, or only appended to since the cache was written
+    size_t covered = static_cast<size_t>(header.covered_bytes);
+    bool unchanged = header.file_size == text.size() && header.file_mtime == modificationTime(file_path);
+    bool grown = text.size() > header.file_size;
+    if ((!unchanged && !grown) || covered > text.size() || edgeHash(text, covered) != header.edge_hash) {
+        return 0;
+    }
+
+    size_t rows = static_cast<size_t>(header.row_count);
+    size_t file_count = static_cast<size_t>(header.source_file_count);
+    size_t function_count = static_cast<size_t>(header.source_function_count);
+
+    IndexReader reader(bytes);
+    reader.skip(sizeof(IndexHeader));
+    std::string_view literals = reader.take(static_cast<size_t>(header.literal_bytes));
+    reader.skip(padded(literals.size()) - literals.size());
+    IndexReader dictionaries(reader.take((file_count + function_count) * sizeof(StringRef)));
+    IndexReader row_text(reader.take(rows * sizeof(RowText)));
+    IndexReader times(reader.take(rows * sizeof(int32_t)));
+    std::string_view levels = reader.take(rows);
+    reader.skip(padded(rows) - rows);
+    IndexReader file_ids(reader.take(rows * sizeof(uint32_t)));
+    IndexReader function_ids(reader.take(rows * sizeof(uint32_t)));
+    IndexReader source_lines(reader.take(rows * sizeof(int32_t)));
+
+    // Check every reference before touching the store, so a damaged cache
+    // is simply ignored
+    auto valid_ref = [&](const StringRef& ref) {
+        uint64_t offset = ref.ref & ~LITERAL_BIT;
+        uint64_t limit = (ref.ref & LITERAL_BIT) ? literals.size() : covered;
+        return offset <= limit && ref.length <= limit - offset;
+    };
+    for (size_t i = 0; i < file_count + function_count; ++i) {
+        if (!valid_ref(dictionaries.read<StringRef>(i))) return 0;
+    }
+    // Ranges are compared without sums that could wrap
+    auto in_text = [&](uint64_t offset, uint64_t length) {
+        return offset <= covered && length <= covered - offset;
+    };
+    for (size_t i = 0; i < rows; ++i) {
+        RowText row = row_text.read<RowText>(i);
+        if (!in_text(row.timestamp_offset, row.timestamp_length) ||
+            !in_text(row.timestamp_offset, row.message_delta) ||
+            !in_text(row.timestamp_offset + row.message_delta, row.message_length) ||
+            static_cast<uint8_t>(levels[i]) >= LevelIndex::LEVEL_COUNT ||
+            file_ids.read<uint32_t>(i) >= file_count || function_ids.read<uint32_t>(i) >= function_count) {
+            return 0;
+        }
+    }
+
+    Arena literal_arena;
+    std::string_view literal_text = literals.empty() ? std::string_view() : literal_arena.copy(literals);
+    auto resolve = [&](const StringRef& ref) {
+        uint64_t offset = ref.ref & ~LITERAL_BIT;
+        const char* base = (ref.ref & LITERAL_BIT) ? literal_text.data() : text.data();
+        return std::string_view(base + offset, static_cast<size_t>(ref.length));
+    };
+    for (size_t i = 0; i < file_count; ++i) {
+        store.source_files.intern(resolve(dictionaries.read<StringRef>(i)));
+    }
+    for (size_t i = 0; i < function_count; ++i) {
+        store.source_functions.intern(resolve(dictionaries.read<StringRef>(file_count + i)));
+    }
+
+    auto& columns = store.columns;
+    for (size_t i = 0; i < rows; ++i) {
+        RowText row = row_text.read<RowText>(i);
+        columns.timestamps.push_back(text.substr(static_cast<size_t>(row.timestamp_offset), row.timestamp_length));
+        columns.messages.push_back(text.substr(static_cast<size_t>(row.timestamp_offset + row.message_delta),
+                                               row.message_length));
+        columns.times.push_back(times.read<int32_t>(i));
+        columns.levels.push_back(static_cast<uint8_t>(levels[i]));
+        columns.source_files.push_back(file_ids.read<uint32_t>(i));
+        columns.source_functions.push_back(function_ids.read<uint32_t>(i));
+        columns.source_lines.push_back(source_lines.read<int32_t>(i));
+    }
+    if (literal_arena.capacity() > 0) {
+        store.arenas.push_back(std::move(literal_arena));
+    }
+    store.level_index.extend(rows);
+    store.time_index.extend(rows);
+    store.published.store(rows, std::memory_order_release);
+
+    line_count = static_cast<size_t>(header.line_count);
+    return covered;
+}
+
+bool saveIndexCache(const std::string& file_path, const LogStore& store, size_t line_count) {
+    // Lazy stores don't fill the columns the cache is made of, and merged
+    // stores span several files
+    if (store.isLazy() || store.isMerged()) {
+        return false;
+    }
+    
+    std::string_view text = store.text();
+    uintptr_t text_begin = reinterpret_cast<uintptr_t>(text.data());
+    uintptr_t text_end = text_begin + text.size();
+    auto in_text = [&](std::string_view view) {
+        uintptr_t begin = reinterpret_cast<uintptr_t>(view.data());
+        return view.data() && begin >= text_begin && begin + view.size() <= text_end;
+    };
+
+    // Only whole lines are cached; a final unterminated line is reparsed later
+    size_t last_newline = text.rfind('\n');
+    size_t covered = last_newline == std::string_view::npos ? 0 : last_newline + 1;
+    size_t rows = store.size();
+    if (rows > 0 && reinterpret_cast<uintptr_t>(store.message(rows - 1).data()) >= text_begin + covered) {
+        rows--;
+    }
+    if (covered < text.size() && line_count > 0) {
+        line_count--;
+    }
+
+    // Dictionary strings may be parser literals rather than views of the log
+    std::string literals;
+    std::vector<StringRef> dictionaries;
+    auto add_strings = [&](const StringDictionary& dictionary) {
+        for (uint32_t id = 0; id < dictionary.size(); ++id) {
+            std::string_view value = dictionary[id];
+            if (in_text(value)) {
+                dictionaries.push_back(StringRef{reinterpret_cast<uintptr_t>(value.data()) - text_begin, value.size()});
+            } else {
+                dictionaries.push_back(StringRef{LITERAL_BIT | literals.size(), value.size()});
+                literals.append(value);
+            }
+        }
+    };
+    add_strings(store.sourceFiles());
+    add_strings(store.sourceFunctions());
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.schema = static_cast<uint64_t>(store.schema());
+    header.file_size = text.size();
+    header.file_mtime = modificationTime(file_path);
+    header.covered_bytes = covered;
+    header.line_count = line_count;
+    header.row_count = rows;
+    header.source_file_count = store.sourceFiles().size();
+    header.source_function_count = store.sourceFunctions().size();
+    header.literal_bytes = literals.size();
+    header.edge_hash = edgeHash(text, covered);
+
+    // Write to a temporary file and rename it into place, so a reader never
+    // sees a half-written cache
+    std::string cache_path = indexCachePath(file_path);
+    std::string temp_path = cache_path + ".tmp";
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    const char padding[8] = {};
+    auto write = [&](const void* data, size_t size) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    };
+    auto write_column = [&](const auto& column) {
+        column.forEachSpan(0, rows, [&](const auto* values, size_t, size_t count) {
+            write(values, count * sizeof(*values));
+        });
+    };
+    write(&header, sizeof(header));
+    write(literals.data(), literals.size());
+    write(padding, padded(literals.size()) - literals.size());
+    write(dictionaries.data(), dictionaries.size() * sizeof(StringRef));
+
+    // Row text in fixed-size pieces to bound the staging buffer
+    const size_t ROWS_PER_WRITE = 64 * 1024;
+    std::vector<RowText> row_text;
+    bool text_ok = true;
+    for (size_t first = 0; first < rows && text_ok; first += ROWS_PER_WRITE) {
+        size_t end = std::min(rows, first + ROWS_PER_WRITE);
+        row_text.clear();
+        for (size_t i = first; i < end; ++i) {
+            LogEntryView entry = store[i];
+            if (!in_text(entry.timestamp) || !in_text(entry.message) || entry.message.data() < entry.timestamp.data()) {
+                text_ok = false;
+                break;
+            }
+            uint64_t timestamp_offset = reinterpret_cast<uintptr_t>(entry.timestamp.data()) - text_begin;
+            row_text.push_back(RowText{
+                timestamp_offset,
+                static_cast<uint32_t>(entry.timestamp.size()),
+                static_cast<uint32_t>(entry.message.data() - entry.timestamp.data()),
+                static_cast<uint32_t>(entry.message.size()),
+            });
+        }
+        write(row_text.data(), row_text.size() * sizeof(RowText));
+    }
+
+    write_column(store.times());
+    write_column(store.levels());
+    write(padding, padded(rows) - rows);
+    write_column(store.sourceFileIds());
+    write_column(store.sourceFunctionIds());
+    write_column(store.sourceLines());
+    out.close();
+
+    std::error_code error;
+    if (!text_ok || !out) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    // Removing the old cache first keeps ext4 from flushing the new one to
+    // disk synchronously, as it does when a rename replaces a file
+    std::filesystem::remove(cache_path, error);
+    std::filesystem::rename(temp_path, cache_path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef INDEX_CACHE_HPP
+#define INDEX_CACHE_HPP
+
+#include <cstddef>
+#include <string>
+#include "LogStore.hpp"
+
+// On-disk cache of a memory-mapped store's columns, kept next to the log
+// as "<file>.lrindex". Text is stored as offsets into the log, so loading
+// skips parsing entirely. The cache records the log's size and mtime: it
+// is used as-is when both still match, and extended when the log has only
+// grown (checked by hashing the bytes around where the cache stops).
+
+// Sidecar path for file_path
+std::string indexCachePath(const std::string& file_path);
+
+// Fill an empty store, already mapped from file_path, from its cache.
+// Returns the number of bytes of the file the cached rows cover (only
+// whole lines), or 0 if there is no usable cache. line_count receives the
+// lines those bytes held.
+size_t loadIndexCache(const std::string& file_path, LogStore& store, size_t& line_count);
+
+// Write the cache for a store mapped from file_path and fully parsed from
+// line_count lines. A trailing line without a newline is left out so the
+// cache can be extended once it's finished. Returns false on write errors
+// and for lazy stores.
+bool saveIndexCache(const std::string& file_path, const LogStore& store, size_t line_count);
+
+#endif // INDEX_CACHE_HPP
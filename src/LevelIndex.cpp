@@ -0,0 +1,125 @@
+#include "LevelIndex.hpp"
+
+LevelIndex::LevelIndex(const SegmentedColumn<uint8_t>& levels) : levels(levels) {
+}
+
+void LevelIndex::extend(size_t rows) {
+    levels.forEachSpan(indexed, rows, [&](const uint8_t* values, size_t first, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = first + i;
+            if (values[i] < LEVEL_COUNT) {
+                pending[values[i]] |= uint64_t(1) << (row & 63);
+            }
+            if ((row & 63) != 63) continue;
+
+            // Word complete: publish it, and the running totals at block ends
+            bool block_end = (words[0].size() + 1) % BLOCK_WORDS == 0;
+            for (unsigned level = 0; level < LEVEL_COUNT; ++level) {
+                words[level].push_back(pending[level]);
+                totals[level] += popCount(pending[level]);
+                pending[level] = 0;
+                if (block_end) {
+                    block_counts[level].push_back(totals[level]);
+                }
+            }
+        }
+    });
+    indexed = rows > indexed ? rows : indexed;
+}
+
+void LevelIndex::clear() {
+    for (unsigned level = 0; level < LEVEL_COUNT; ++level) {
+        words[level].clear();
+        block_counts[level].clear();
+        pending[level] = 0;
+        totals[level] = 0;
+    }
+    indexed = 0;
+}
+
+uint64_t LevelIndex::tailBits(unsigned mask, size_t word, size_t rows) const {
+    uint64_t result = 0;
+    size_t first = word * 64;
+    size_t end = rows < first + 64 ? rows : first + 64;
+    for (size_t row = first; row < end; ++row) {
+        if ((mask >> levels[row]) & 1u) {
+            result |= uint64_t(1) << (row - first);
+        }
+    }
+    return result;
+}
+
+uint64_t LevelIndex::bits(unsigned mask, size_t word, size_t rows) const {
+    if ((word + 1) * 64 > rows) {
+        return tailBits(mask, word, rows);
+    }
+    uint64_t result = 0;
+    for (unsigned level = 0; level < LEVEL_COUNT; ++level) {
+        if ((mask >> level) & 1u) {
+            result |= words[level][word];
+        }
+    }
+    return result;
+}
+
+uint64_t LevelIndex::blockCount(unsigned mask, size_t block) const {
+    uint64_t result = 0;
+    for (unsigned level = 0; level < LEVEL_COUNT; ++level) {
+        if ((mask >> level) & 1u) {
+            result += block_counts[level][block];
+        }
+    }
+    return result;
+}
+
+size_t LevelIndex::count(unsigned mask, size_t rows) const {
+    mask &= ALL_LEVELS;
+    if (mask == ALL_LEVELS) return rows;
+    if (mask == 0) return 0;
+
+    // Directory for whole blocks, then at most BLOCK_WORDS words and the tail
+    size_t full_words = rows / 64;
+    size_t block = full_words / BLOCK_WORDS;
+    size_t result = block > 0 ? blockCount(mask, block - 1) : 0;
+    for (size_t word = block * BLOCK_WORDS; word < full_words; ++word) {
+        result += popCount(bits(mask, word, rows));
+    }
+    if (rows % 64 != 0) {
+        result += popCount(tailBits(mask, full_words, rows));
+    }
+    return result;
+}
+
+size_t LevelIndex::select(unsigned mask, size_t k, size_t rows) const {
+    mask &= ALL_LEVELS;
+    if (mask == ALL_LEVELS) return k;
+
+    // First block whose running count passes k
+    size_t blocks = rows / 64 / BLOCK_WORDS;
+    size_t low = 0;
+    size_t high = blocks;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (blockCount(mask, middle) > k) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    size_t before = low > 0 ? blockCount(mask, low - 1) : 0;
+
+    // Then the word within it, then the bit within the word
+    size_t words_end = (rows + 63) / 64;
+    for (size_t word = low * BLOCK_WORDS; word < words_end; ++word) {
+        uint64_t word_bits = bits(mask, word, rows);
+        size_t word_count = popCount(word_bits);
+        if (before + word_count > k) {
+            for (size_t skip = k - before; skip > 0; --skip) {
+                word_bits &= word_bits - 1;
+            }
+            return word * 64 + lowestBit(word_bits);
+        }
+        before += word_count;
+    }
+    return rows;
+}
@@ -0,0 +1,93 @@
+#ifndef LEVEL_INDEX_HPP
+#define LEVEL_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "LogEntry.hpp"
+#include "SegmentedColumn.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// One bitmap per LogLevel over a store's level column, with a rank
+// directory so counting the rows of any set of levels, and finding the
+// k-th such row, costs the same however large the file is.
+//
+// Level masks have bit n set for LogLevel n. Levels are disjoint, so the
+// count for a mask is the sum of the per-level counts. Only complete
+// 64-row words are stored; the rows past the last one are read from the
+// level column. Like the store, one writer extends the index while
+// readers query any row count up to LogStore::size().
+class LevelIndex {
+public:
+    static constexpr unsigned LEVEL_COUNT = static_cast<unsigned>(LogLevel::HEADER) + 1;
+    static constexpr unsigned ALL_LEVELS = (1u << LEVEL_COUNT) - 1;
+
+    explicit LevelIndex(const SegmentedColumn<uint8_t>& levels);
+
+    // Index level column rows up to rows (writer only)
+    void extend(size_t rows);
+    void clear();
+
+    // Rows among the first rows whose level is in mask
+    size_t count(unsigned mask, size_t rows) const;
+
+    // Row of the k-th (from 0) match among the first rows; k < count(mask, rows)
+    size_t select(unsigned mask, size_t k, size_t rows) const;
+
+    // Match bits for rows [64 * word, 64 * word + 64), limited to the first rows
+    uint64_t bits(unsigned mask, size_t word, size_t rows) const;
+
+    // Call fn(row) for each match in [begin, rows), in order
+    template <typename Fn>
+    void forEachRow(unsigned mask, size_t begin, size_t rows, Fn&& fn) const {
+        for (size_t word = begin / 64; word * 64 < rows; ++word) {
+            uint64_t word_bits = bits(mask, word, rows);
+            if (word == begin / 64) {
+                word_bits &= ~uint64_t(0) << (begin % 64);
+            }
+            while (word_bits) {
+                fn(word * 64 + lowestBit(word_bits));
+                word_bits &= word_bits - 1;
+            }
+        }
+    }
+
+private:
+    // Words per rank directory block
+    static constexpr size_t BLOCK_WORDS = 8;
+
+    const SegmentedColumn<uint8_t>& levels;
+    SegmentedColumn<uint64_t> words[LEVEL_COUNT];
+    SegmentedColumn<uint64_t> block_counts[LEVEL_COUNT];   // Set bits through the end of each block
+
+    // Writer state
+    uint64_t pending[LEVEL_COUNT] = {};
+    uint64_t totals[LEVEL_COUNT] = {};
+    size_t indexed = 0;
+
+    static unsigned popCount(uint64_t value) {
+#ifdef _MSC_VER
+        return static_cast<unsigned>(__popcnt64(value));
+#else
+        return static_cast<unsigned>(__builtin_popcountll(value));
+#endif
+    }
+
+    static unsigned lowestBit(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+    }
+
+    // Bits from the level column for a word that isn't stored yet
+    uint64_t tailBits(unsigned mask, size_t word, size_t rows) const;
+    uint64_t blockCount(unsigned mask, size_t block) const;
+};
+
+#endif // LEVEL_INDEX_HPP
@@ -0,0 +1,225 @@
+#include "LineParser.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+// Level names by perfect hash: (length + first character) % 8 differs for
+// every name, which the static_assert below checks when this compiles
+struct LevelSlot {
+    std::string_view name;
+    LogLevel level = LogLevel::DEBUG;
+};
+
+static constexpr LevelSlot LEVEL_NAMES[] = {
+    {"DEBUG", LogLevel::DEBUG}, {"INFO", LogLevel::INFO},     {"WARN", LogLevel::WARN},
+    {"ERROR", LogLevel::ERROR}, {"FOOTER", LogLevel::FOOTER}, {"HEADER", LogLevel::HEADER},
+};
+
+static constexpr size_t LEVEL_SLOTS = 8;
+
+static constexpr size_t levelHash(std::string_view name) {
+    return (name.size() + static_cast<unsigned char>(name[0])) % LEVEL_SLOTS;
+}
+
+struct LevelTable {
+    LevelSlot slots[LEVEL_SLOTS];
+    bool perfect = true;
+};
+
+static constexpr LevelTable buildLevelTable() {
+    LevelTable table{};
+    for (const LevelSlot& level : LEVEL_NAMES) {
+        LevelSlot& slot = table.slots[levelHash(level.name)];
+        if (!slot.name.empty()) {
+            table.perfect = false;
+        }
+        slot = level;
+    }
+    return table;
+}
+
+static constexpr LevelTable LEVEL_TABLE = buildLevelTable();
+static_assert(LEVEL_TABLE.perfect, "level names collide in levelHash()");
+
+LogLevel parseLogLevel(std::string_view level_str) {
+    // Remove leading/trailing whitespace
+    size_t begin = 0;
+    size_t end = level_str.size();
+    while (begin < end && (level_str[begin] == ' ' || level_str[begin] == '\t')) begin++;
+    while (end > begin && (level_str[end - 1] == ' ' || level_str[end - 1] == '\t')) end--;
+    if (begin == end) {
+        return LogLevel::DEBUG;
+    }
+    level_str = level_str.substr(begin, end - begin);
+
+    const LevelSlot& slot = LEVEL_TABLE.slots[levelHash(level_str)];
+    return slot.name == level_str ? slot.level : LogLevel::DEBUG; // Default fallback
+}
+
+const char* logLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG:  return "DEBUG";
+        case LogLevel::INFO:   return "INFO";
+        case LogLevel::WARN:   return "WARN";
+        case LogLevel::ERROR:  return "ERROR";
+        case LogLevel::FOOTER: return "FOOTER";
+        case LogLevel::HEADER: return "HEADER";
+        default:               return "DEBUG";
+    }
+}
+
+const char* logSchemaName(LogSchemaId schema) {
+    switch (schema) {
+        case LogSchemaId::THREAD: return "thread";
+        case LogSchemaId::FRAME:  return "frame";
+        default:                  return "standard";
+    }
+}
+
+bool parseLogSchemaName(std::string_view name, LogSchemaId& schema) {
+    const LogSchemaId SCHEMAS[] = {LogSchemaId::STANDARD, LogSchemaId::THREAD, LogSchemaId::FRAME};
+    for (LogSchemaId candidate : SCHEMAS) {
+        std::string_view candidate_name = logSchemaName(candidate);
+        if (candidate_name.size() == name.size() &&
+            std::equal(name.begin(), name.end(), candidate_name.begin(),
+                       [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; })) {
+            schema = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Characters matched by \s in the original source-info regex
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static void setUnknownSource(std::string_view source_info, LogEntryView& entry) {
+    entry.source_file = source_info;
+    entry.source_function = "unknown";
+    entry.source_line = 0;
+}
+
+void parseSourceInfo(std::string_view source_info, LogEntryView& entry) {
+    // Single backwards pass equivalent to matching (.*)\s*->\s*(.*)\(\):\s*(\d+):
+    // the line number is the trailing digit run, the function ends at the
+    // "():" just before it and the file ends at the last "->" before that.
+    size_t digits_begin = source_info.size();
+    while (digits_begin > 0 && isDigit(source_info[digits_begin - 1])) {
+        digits_begin--;
+    }
+    if (digits_begin == source_info.size()) {
+        setUnknownSource(source_info, entry);
+        return;
+    }
+    
+    size_t suffix_begin = digits_begin;
+    while (suffix_begin > 0 && isSpace(source_info[suffix_begin - 1])) {
+        suffix_begin--;
+    }
+    if (suffix_begin < 3 || source_info.compare(suffix_begin - 3, 3, "():") != 0) {
+        setUnknownSource(source_info, entry);
+        return;
+    }
+    
+    std::string_view location = source_info.substr(0, suffix_begin - 3);
+    size_t arrow = location.rfind("->");
+    if (arrow == std::string_view::npos) {
+        setUnknownSource(source_info, entry);
+        return;
+    }
+    
+    int line_number = 0;
+    const char* digits_end = source_info.data() + source_info.size();
+    auto result = std::from_chars(source_info.data() + digits_begin, digits_end, line_number);
+    if (result.ec != std::errc() || result.ptr != digits_end) {
+        // Line number doesn't fit in an int
+        setUnknownSource(source_info, entry);
+        return;
+    }
+    
+    size_t function_begin = arrow + 2;
+    while (function_begin < location.size() && isSpace(location[function_begin])) {
+        function_begin++;
+    }
+    
+    entry.source_file = location.substr(0, arrow);
+    entry.source_function = location.substr(function_begin);
+    entry.source_line = line_number;
+}
+
+// Two-digit field at text[pos], or -1
+static int parseTwoDigits(std::string_view text, size_t pos) {
+    if (pos + 2 > text.size() || !isDigit(text[pos]) || !isDigit(text[pos + 1])) {
+        return -1;
+    }
+    return (text[pos] - '0') * 10 + (text[pos + 1] - '0');
+}
+
+int32_t parseTimeOfDay(std::string_view timestamp) {
+    int hours = parseTwoDigits(timestamp, 0);
+    int minutes = parseTwoDigits(timestamp, 3);
+    int seconds = parseTwoDigits(timestamp, 6);
+    if (hours < 0 || minutes < 0 || seconds < 0 || timestamp[2] != ':' || timestamp[5] != ':' ||
+        hours > 23 || minutes > 59 || seconds > 60) {
+        return -1;
+    }
+    
+    // Optional fraction, truncated to milliseconds
+    int milliseconds = 0;
+    size_t pos = 8;
+    if (pos < timestamp.size() && (timestamp[pos] == '.' || timestamp[pos] == ',')) {
+        int scale = 100;
+        for (pos++; pos < timestamp.size() && isDigit(timestamp[pos]); pos++) {
+            milliseconds += (timestamp[pos] - '0') * scale;
+            scale /= 10;
+        }
+    }
+    
+    return ((hours * 60 + minutes) * 60 + seconds) * 1000 + milliseconds;
+}
+
+bool parseLogLine(std::string_view line, LogEntryView& entry, LogSchemaId schema) {
+    // Locate the separators ending the first fields
+    size_t separators[MAX_FIELD_SEPARATORS]{};
+    size_t separator_count = 0;
+    size_t separator = line.find(FIELD_SEPARATOR);
+    while (separator != std::string_view::npos && separator_count < MAX_FIELD_SEPARATORS) {
+        separators[separator_count++] = separator;
+        separator = line.find(FIELD_SEPARATOR, separator + 1);
+    }
+    return parseLogFields(line, separators, separator_count, entry, schema);
+}
+
+bool isLogLine(std::string_view line, const size_t* separators, size_t separator_count, LogSchemaId schema) {
+    return withLogSchema(schema, [&](auto schema_type) {
+        return isLogLineAs<decltype(schema_type)>(line, separators, separator_count);
+    });
+}
+
+std::string_view logMessageField(std::string_view line, LogSchemaId schema) {
+    return withLogSchema(schema, [&](auto schema_type) {
+        using Schema = decltype(schema_type);
+        // Only the separators up to the end of the message are needed
+        size_t separators[MAX_FIELD_SEPARATORS]{};
+        size_t separator_count = 0;
+        size_t separator = line.find(FIELD_SEPARATOR);
+        while (separator != std::string_view::npos && separator_count <= Schema::MESSAGE) {
+            separators[separator_count++] = separator;
+            separator = line.find(FIELD_SEPARATOR, separator + 1);
+        }
+        return logFieldAs<Schema>(line, separators, separator_count, Schema::MESSAGE);
+    });
+}
+
+bool parseLogFields(std::string_view line, const size_t* separators, size_t separator_count,
+                    LogEntryView& entry, LogSchemaId schema) {
+    return withLogSchema(schema, [&](auto schema_type) {
+        return parseLogFieldsAs<decltype(schema_type)>(line, separators, separator_count, entry);
+    });
+}
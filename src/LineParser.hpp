@@ -0,0 +1,231 @@
+#ifndef LINE_PARSER_HPP
+#define LINE_PARSER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "LogEntry.hpp"
+#include "SeparatorScanner.hpp"
+
+// Field-level parsing shared by every LogParser load path. All results are
+// views into the input line; nothing here allocates.
+
+const char FIELD_SEPARATOR = 31; // ASCII field separator
+
+// Most field separators recorded per line, which bounds schema fields
+const size_t MAX_FIELD_SEPARATORS = 8;
+
+// What a field of a log line holds
+enum class LogField : uint8_t {
+    TIMESTAMP,   // "HH:MM:SS[.fff]"
+    LEVEL,
+    MESSAGE,
+    SOURCE,      // "source_file -> function(): line_number"
+    SKIP,        // Anything else (thread id, frame number, ...); not read
+};
+
+// Position of kind among Fields, sizeof...(Fields) if it isn't one
+template <LogField... Fields>
+constexpr size_t logFieldPosition(LogField kind) {
+    constexpr LogField FIELDS[] = {Fields...};
+    for (size_t i = 0; i < sizeof...(Fields); ++i) {
+        if (FIELDS[i] == kind) return i;
+    }
+    return sizeof...(Fields);
+}
+
+// Position of the last field that's read
+template <LogField... Fields>
+constexpr size_t lastReadField() {
+    constexpr LogField FIELDS[] = {Fields...};
+    size_t last = 0;
+    for (size_t i = 0; i < sizeof...(Fields); ++i) {
+        if (FIELDS[i] != LogField::SKIP) last = i;
+    }
+    return last;
+}
+
+// A line layout: its fields in order, separated by FIELD_SEPARATOR. Every
+// position is a constant, so parseLogFieldsAs<Schema>() compiles to direct
+// separator lookups with nothing about the layout decided per line.
+// Fields through the last one read must be present; trailing SKIP fields
+// may be missing.
+template <LogField... Fields>
+struct LogSchema {
+    static constexpr size_t FIELD_COUNT = sizeof...(Fields);
+    static constexpr size_t TIMESTAMP = logFieldPosition<Fields...>(LogField::TIMESTAMP);
+    static constexpr size_t LEVEL = logFieldPosition<Fields...>(LogField::LEVEL);
+    static constexpr size_t MESSAGE = logFieldPosition<Fields...>(LogField::MESSAGE);
+    static constexpr size_t SOURCE = logFieldPosition<Fields...>(LogField::SOURCE);
+    static constexpr size_t LAST = lastReadField<Fields...>();
+
+    static_assert(FIELD_COUNT <= MAX_FIELD_SEPARATORS, "schema has more fields than separators are recorded");
+    static_assert(LAST > 0, "schema needs at least two fields");
+};
+
+// The built-in schemas
+using StandardSchema = LogSchema<LogField::TIMESTAMP, LogField::LEVEL, LogField::MESSAGE, LogField::SOURCE>;
+using ThreadSchema = LogSchema<LogField::TIMESTAMP, LogField::SKIP, LogField::LEVEL, LogField::MESSAGE,
+                               LogField::SOURCE>;
+using FrameSchema = LogSchema<LogField::SKIP, LogField::TIMESTAMP, LogField::LEVEL, LogField::MESSAGE,
+                              LogField::SOURCE>;
+
+// Chooses a built-in schema at run time
+enum class LogSchemaId : uint8_t {
+    STANDARD,    // timestamp<FS>level<FS>message<FS>source_info
+    THREAD,      // timestamp<FS>thread<FS>level<FS>message<FS>source_info
+    FRAME,       // frame<FS>timestamp<FS>level<FS>message<FS>source_info
+};
+
+// "standard", "thread" or "frame"
+const char* logSchemaName(LogSchemaId schema);
+
+// Schema named name (as logSchemaName() gives it, any case); false if none is
+bool parseLogSchemaName(std::string_view name, LogSchemaId& schema);
+
+// Call fn with a default-constructed schema type for id, so the caller's
+// loop is instantiated once per schema and the choice is made once per
+// buffer rather than per line
+template <typename Fn>
+decltype(auto) withLogSchema(LogSchemaId schema, Fn&& fn) {
+    switch (schema) {
+        case LogSchemaId::THREAD: return fn(ThreadSchema());
+        case LogSchemaId::FRAME:  return fn(FrameSchema());
+        default:                  return fn(StandardSchema());
+    }
+}
+
+// Map a level field ("DEBUG", " WARN ", ...) to LogLevel, DEBUG if unknown.
+// Names are found with a perfect hash: one table probe and one comparison.
+LogLevel parseLogLevel(std::string_view level_str);
+
+// The level's name as it appears in a log line
+const char* logLevelName(LogLevel level);
+
+// Parse "source_file -> function(): line_number" into entry's source fields.
+// Falls back to the whole string as source_file, "unknown" and 0.
+void parseSourceInfo(std::string_view source_info, LogEntryView& entry);
+
+// Parse an "HH:MM:SS" or "HH:MM:SS.fff" timestamp into milliseconds since
+// midnight. Returns -1 if the text isn't a time of day.
+int32_t parseTimeOfDay(std::string_view timestamp);
+
+// Whether a line with the first separator_count (at most
+// MAX_FIELD_SEPARATORS) of its field separators at these offsets has every
+// field Schema reads. A last read field without a separator after it only
+// counts if it is non-empty.
+template <typename Schema>
+bool isLogLineAs(std::string_view line, const size_t* separators, size_t separator_count) {
+    return separator_count > Schema::LAST ||
+           (separator_count == Schema::LAST && separators[Schema::LAST - 1] + 1 != line.size());
+}
+
+// Field at position of a line isLogLineAs<Schema>() accepted; empty if
+// the schema has no such field
+template <typename Schema>
+std::string_view logFieldAs(std::string_view line, const size_t* separators, size_t separator_count,
+                            size_t position) {
+    if (position >= Schema::FIELD_COUNT) {
+        return std::string_view();
+    }
+    size_t begin = position == 0 ? 0 : separators[position - 1] + 1;
+    size_t end = position < separator_count ? separators[position] : line.size();
+    return line.substr(begin, end - begin);
+}
+
+// Parse a line laid out as Schema. Returns false for lines without enough
+// fields, which callers silently skip. Fields the schema lacks are left
+// empty, with a DEBUG level and "unknown" source function.
+template <typename Schema>
+bool parseLogFieldsAs(std::string_view line, const size_t* separators, size_t separator_count,
+                      LogEntryView& entry) {
+    if (!isLogLineAs<Schema>(line, separators, separator_count)) {
+        return false;
+    }
+    entry.timestamp = logFieldAs<Schema>(line, separators, separator_count, Schema::TIMESTAMP);
+    entry.level = parseLogLevel(logFieldAs<Schema>(line, separators, separator_count, Schema::LEVEL));
+    entry.message = logFieldAs<Schema>(line, separators, separator_count, Schema::MESSAGE);
+    parseSourceInfo(logFieldAs<Schema>(line, separators, separator_count, Schema::SOURCE), entry);
+    return true;
+}
+
+// Parse a line laid out as schema (timestamp<FS>level<FS>message<FS>source_info
+// by default). Returns false for lines without enough fields.
+bool parseLogLine(std::string_view line, LogEntryView& entry, LogSchemaId schema = LogSchemaId::STANDARD);
+
+// parseLogLine() for a line whose first separator_count (at most
+// MAX_FIELD_SEPARATORS) field separator offsets are already known
+bool parseLogFields(std::string_view line, const size_t* separators, size_t separator_count,
+                    LogEntryView& entry, LogSchemaId schema = LogSchemaId::STANDARD);
+
+// Whether parseLogFields() would accept the line, without parsing any field
+bool isLogLine(std::string_view line, const size_t* separators, size_t separator_count,
+               LogSchemaId schema = LogSchemaId::STANDARD);
+
+// Message field of a line isLogLine() accepted
+std::string_view logMessageField(std::string_view line, LogSchemaId schema = LogSchemaId::STANDARD);
+
+// Call on_line(line, separators, separator_count) for every line of text,
+// with the offsets of up to its first MAX_FIELD_SEPARATORS field
+// separators, and return
+// the number of lines seen. Line and field boundaries for whole blocks
+// come from scanSeparators(), which makes this the fast path for large
+// buffers. Trailing "\r" is stripped from lines.
+template <typename OnLine>
+size_t scanLogLines(std::string_view text, OnLine&& on_line) {
+    const size_t BLOCK_SIZE = 64 * 1024;
+    std::vector<uint32_t> positions(std::min(BLOCK_SIZE, text.size()));
+    
+    size_t separators[MAX_FIELD_SEPARATORS]{};
+    size_t separator_count = 0;
+    size_t line_start = 0;
+    size_t line_count = 0;
+    
+    auto finish_line = [&](size_t line_end) {
+        std::string_view line = text.substr(line_start, line_end - line_start);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        on_line(line, static_cast<const size_t*>(separators), separator_count);
+        line_count++;
+    };
+    
+    for (size_t block = 0; block < text.size(); block += BLOCK_SIZE) {
+        size_t block_size = std::min(BLOCK_SIZE, text.size() - block);
+        size_t count = scanSeparators(text.data() + block, block_size, positions.data());
+        for (size_t i = 0; i < count; ++i) {
+            size_t pos = block + positions[i];
+            if (text[pos] == '\n') {
+                finish_line(pos);
+                line_start = pos + 1;
+                separator_count = 0;
+            } else if (separator_count < MAX_FIELD_SEPARATORS) {
+                separators[separator_count++] = pos - line_start;
+            }
+        }
+    }
+    
+    // Final line without a trailing newline
+    if (line_start < text.size()) {
+        finish_line(text.size());
+    }
+    return line_count;
+}
+
+// Parse every line of text as schema, calling on_entry(const LogEntryView&)
+// for each valid entry, and return the number of lines seen
+template <typename OnEntry>
+size_t parseLogText(std::string_view text, OnEntry&& on_entry, LogSchemaId schema = LogSchemaId::STANDARD) {
+    return withLogSchema(schema, [&](auto schema_type) {
+        using Schema = decltype(schema_type);
+        LogEntryView entry;
+        return scanLogLines(text, [&](std::string_view line, const size_t* separators, size_t separator_count) {
+            if (parseLogFieldsAs<Schema>(line, separators, separator_count, entry)) {
+                on_entry(static_cast<const LogEntryView&>(entry));
+            }
+        });
+    });
+}
+
+#endif // LINE_PARSER_HPP
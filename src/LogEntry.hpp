@@ -2,6 +2,7 @@
 #define LOG_ENTRY_HPP
 
 #include <string>
+#include <string_view>
 
 enum class LogLevel {
     DEBUG,
@@ -21,4 +22,25 @@ struct LogEntry {
     int source_line;
 };
 
+// Non-owning entry whose text fields point into the buffer the line was
+// parsed from (e.g. a memory-mapped file held by LogStore)
+struct LogEntryView {
+    std::string_view timestamp;
+    LogLevel level;
+    std::string_view message;
+    std::string_view source_file;
+    std::string_view source_function;
+    int source_line;
+};
+
+inline LogEntry toLogEntry(const LogEntryView& view) {
+    return LogEntry{std::string(view.timestamp), view.level, std::string(view.message),
+                    std::string(view.source_file), std::string(view.source_function), view.source_line};
+}
+
+inline LogEntryView toLogEntryView(const LogEntry& entry) {
+    return LogEntryView{entry.timestamp, entry.level, entry.message,
+                        entry.source_file, entry.source_function, entry.source_line};
+}
+
 #endif // LOG_ENTRY_HPP
@@ -0,0 +1,142 @@
+#include "LogMerger.hpp"
+#include "LineParser.hpp"
+#include "Metrics.hpp"
+#include "TimeIndex.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+
+// Bytes of text parsed at a time, and slices a source may have waiting
+// for the merge. Together they bound the memory each source holds.
+static const size_t SLICE_BYTES = 256 * 1024;
+static const size_t SLICES_AHEAD = 4;
+
+struct MergeEntry {
+    LogEntryView entry;
+    int64_t clock;      // TimeIndex clock within the entry's own log
+    int32_t time;
+};
+
+using MergeSlice = std::vector<MergeEntry>;
+
+// One input's parsed slices, handed from its parsing thread to the merge
+struct MergeSource {
+    std::deque<MergeSlice> slices;
+    bool finished = false;
+    std::mutex mutex;
+    std::condition_variable slice_ready;
+    std::condition_variable slice_taken;
+};
+
+static void parseSource(std::string_view text, LogSchemaId schema, MergeSource& source,
+                        const std::atomic<bool>& stop_requested,
+                        const std::atomic<bool>& merge_done) {
+    int64_t previous_clock = -1;
+    size_t offset = 0;
+    while (offset < text.size() && !stop_requested && !merge_done) {
+        size_t end = offset + SLICE_BYTES < text.size() ? text.find('\n', offset + SLICE_BYTES) : std::string_view::npos;
+        end = end == std::string_view::npos ? text.size() : end + 1;
+
+        MergeSlice slice;
+        {
+            StageTimer timer(MetricStage::PARSE);
+            parseLogText(text.substr(offset, end - offset), [&](const LogEntryView& entry) {
+                int32_t time = parseTimeOfDay(entry.timestamp);
+                slice.push_back(MergeEntry{entry, TimeIndex::advance(previous_clock, time), time});
+            }, schema);
+            timer.addItems(slice.size());
+        }
+        offset = end;
+        if (slice.empty()) continue;
+
+        std::unique_lock<std::mutex> lock(source.mutex);
+        source.slice_taken.wait(lock, [&] { return source.slices.size() < SLICES_AHEAD || merge_done; });
+        source.slices.push_back(std::move(slice));
+        lock.unlock();
+        source.slice_ready.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(source.mutex);
+        source.finished = true;
+    }
+    source.slice_ready.notify_one();
+}
+
+bool mergeLogs(const std::vector<std::string_view>& texts, LogSchemaId schema,
+               const std::atomic<bool>& stop_requested, const MergeVisitor& on_entry) {
+    std::vector<MergeSource> sources(texts.size());
+    std::atomic<bool> merge_done{false};
+    std::vector<std::thread> threads;
+    for (size_t s = 0; s < texts.size(); ++s) {
+        threads.emplace_back(parseSource, texts[s], schema, std::ref(sources[s]), std::cref(stop_requested),
+                             std::cref(merge_done));
+    }
+
+    // Slice each source is being merged from, and the position in it
+    std::vector<MergeSlice> current(texts.size());
+    std::vector<size_t> positions(texts.size(), 0);
+
+    // Move on to source's next slice, waiting for it; false once it has none left
+    auto next_slice = [&](size_t s) {
+        MergeSource& source = sources[s];
+        std::unique_lock<std::mutex> lock(source.mutex);
+        source.slice_ready.wait(lock, [&] { return !source.slices.empty() || source.finished; });
+        if (source.slices.empty() || stop_requested) {
+            return false;
+        }
+        current[s] = std::move(source.slices.front());
+        source.slices.pop_front();
+        positions[s] = 0;
+        lock.unlock();
+        source.slice_taken.notify_one();
+        return true;
+    };
+
+    // Clock of each source's next entry; the source breaks ties
+    using Head = std::pair<int64_t, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    for (size_t s = 0; s < texts.size(); ++s) {
+        if (next_slice(s)) {
+            heads.push({current[s][0].clock, s});
+        }
+    }
+
+    bool completed = true;
+    while (completed && !heads.empty()) {
+        size_t s = heads.top().second;
+        heads.pop();
+
+        // Logs are mostly ordered already, so take runs from the smallest
+        // source for as long as they sort before every other source's head
+        bool more = true;
+        do {
+            const MergeEntry& next = current[s][positions[s]++];
+            if (!on_entry(next.entry, next.time, s)) {
+                completed = false;
+                break;
+            }
+            if (positions[s] == current[s].size() && !(more = next_slice(s))) {
+                break;
+            }
+        } while (heads.empty() || Head{current[s][positions[s]].clock, s} < heads.top());
+
+        if (completed && more) {
+            heads.push({current[s][positions[s]].clock, s});
+        }
+    }
+
+    // Wake sources waiting for room so they see the merge is over
+    merge_done = true;
+    for (MergeSource& source : sources) {
+        std::lock_guard<std::mutex> lock(source.mutex);
+        source.slice_taken.notify_one();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return completed && !stop_requested;
+}
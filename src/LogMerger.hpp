@@ -0,0 +1,28 @@
+#ifndef LOG_MERGER_HPP
+#define LOG_MERGER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+#include "LineParser.hpp"
+#include "LogEntry.hpp"
+
+// Called for each entry in merged order with its parsed time of day and the
+// index of the text it came from; return false to stop merging
+using MergeVisitor = std::function<bool(const LogEntryView& entry, int32_t time, size_t origin)>;
+
+// K-way merge of several logs by timestamp. Each text is parsed on its own
+// thread, one slice at a time and a few slices ahead of the merge, so memory
+// use doesn't depend on the size of the inputs; entries are views into the
+// texts, whose lines are laid out as schema. Entries are ordered by their TimeIndex clock within their own log
+// (rows without a time stay right after the row before them), ties going
+// to the earlier text, so each log's own order is kept.
+//
+// Returns false if stopped by stop_requested or on_entry.
+bool mergeLogs(const std::vector<std::string_view>& texts, LogSchemaId schema,
+               const std::atomic<bool>& stop_requested, const MergeVisitor& on_entry);
+
+#endif // LOG_MERGER_HPP
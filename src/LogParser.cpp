@@ -1,44 +1,476 @@
 #include "LogParser.hpp"
+#include "CompressedFile.hpp"
+#include "DiagnosticLog.hpp"
+#include "FileFollower.hpp"
+#include "IndexCache.hpp"
+#include "LineParser.hpp"
+#include "LogMerger.hpp"
+#include "Metrics.hpp"
+#include "SocketListener.hpp"
 #include <fstream>
 #include <iostream>
-#include <regex>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
 #include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <condition_variable>
+#include <iterator>
+#include <optional>
+#include <unordered_map>
 
-// Simple logging function for LogParser
-void logToFile(const std::string& level, const std::string& message) {
-    static std::ofstream logFile("logreader_debug.log", std::ios::app);
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+// Split text into byte ranges of roughly range_bytes, each snapped forward
+// to just past the next newline so no line straddles two ranges
+static std::vector<size_t> splitAtNewlines(std::string_view text, size_t range_bytes) {
+    std::vector<size_t> bounds{0};
+    while (bounds.back() < text.size()) {
+        size_t target = bounds.back() + range_bytes;
+        size_t newline = target < text.size() ? text.find('\n', target) : std::string_view::npos;
+        bounds.push_back(newline == std::string_view::npos ? text.size() : newline + 1);
+    }
+    return bounds;
+}
+
+// Per-range output of the parse engine. The batch type decides how parsed
+// entries are kept: as columns of views into the parsed buffer, as columns
+// copied into the batch's own arena, as owning LogEntry copies, or as just
+// each line and its level for lazy stores.
+struct ViewBatch : LogBatch {
+    explicit ViewBatch(size_t = 0) : LogBatch(false) {}
+};
+
+struct CopiedBatch : LogBatch {
+    explicit CopiedBatch(size_t = 0) : LogBatch(true) {}
+};
+
+struct OwnedBatch {
+    std::vector<LogEntry> entries;
+    
+    explicit OwnedBatch(size_t = 0) {}
+    void add(const LogEntryView& view) { entries.push_back(toLogEntry(view)); }
+    size_t size() const { return entries.size(); }
+};
+
+// Views for parseEntries(), valid only while the parsed text is
+struct EntryListBatch {
+    std::vector<LogEntryView> entries;
+    
+    explicit EntryListBatch(size_t = 0) {}
+    void add(const LogEntryView& view) { entries.push_back(view); }
+    size_t size() const { return entries.size(); }
+};
+
+struct LazyBatch : LogBatch {
+    explicit LazyBatch(size_t = 0) : LogBatch(false) {}
+};
+
+// Parse range into batch and return the number of lines seen
+template <typename Batch>
+static size_t parseInto(std::string_view range, LogSchemaId schema, Batch& batch) {
+    return parseLogText(range, [&](const LogEntryView& view) { batch.add(view); }, schema);
+}
+
+// Lazy rows need only the separator offsets, the level and the time
+static size_t parseInto(std::string_view range, LogSchemaId schema, LazyBatch& batch) {
+    return withLogSchema(schema, [&](auto schema_type) {
+        using Schema = decltype(schema_type);
+        return scanLogLines(range, [&](std::string_view line, const size_t* separators, size_t separator_count) {
+            if (isLogLineAs<Schema>(line, separators, separator_count)) {
+                batch.addLine(line, parseLogLevel(logFieldAs<Schema>(line, separators, separator_count, Schema::LEVEL)),
+                              parseTimeOfDay(logFieldAs<Schema>(line, separators, separator_count, Schema::TIMESTAMP)));
+            }
+        });
+    });
+}
+
+template <typename Batch>
+struct RangeResult {
+    Batch batch;
+    size_t lines = 0;
+    bool done = false;
+};
+
+// Each progress message makes the UI repaint, so while a parse runs they're
+// sent at most every 30 ms (as SearchWorker does) and the rest are dropped.
+// Messages that end a parse are always sent.
+class ProgressThrottle {
+public:
+    bool due() {
+        auto now = std::chrono::steady_clock::now();
+        if (sent && now - last_sent < INTERVAL) {
+            return false;
+        }
+        sent = true;
+        last_sent = now;
+        return true;
+    }
+
+private:
+    static constexpr std::chrono::milliseconds INTERVAL{30};
+    std::chrono::steady_clock::time_point last_sent;
+    bool sent = false;
+};
+
+static std::string progressMessage(size_t bytes_done, size_t total_bytes, size_t total_lines) {
+    int progress = total_bytes ? static_cast<int>((bytes_done * 100) / total_bytes) : 100;
+    return "Parsing... " + std::to_string(progress) + "% (" + std::to_string(total_lines) + " lines)";
+}
+
+// Parse text on a pool of worker threads. Ranges are parsed independently and
+// handed to on_range(batch, lines, bytes_done) on the calling thread in file
+// order, each as soon as every range before it has finished. A non-zero
+// max_pending_bytes limits how far workers parse ahead of on_range, which
+// bounds the memory held by batches waiting for it.
+template <typename Batch, typename RangeCallback>
+static void parseParallel(std::string_view text, unsigned thread_count, LogSchemaId schema,
+                          const std::atomic<bool>& stop_requested, RangeCallback&& on_range,
+                          size_t max_pending_bytes = 0) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    // Many more ranges than threads keeps the pool balanced and lets results
+    // stream out in order long before the last range is parsed
+    const size_t MIN_RANGE_BYTES = 256 * 1024;
+    const size_t MAX_RANGE_BYTES = 16 * 1024 * 1024;
+    size_t range_bytes = std::clamp(text.size() / (thread_count * 16), MIN_RANGE_BYTES, MAX_RANGE_BYTES);
+    if (max_pending_bytes) {
+        range_bytes = std::min(range_bytes, std::max(MIN_RANGE_BYTES, max_pending_bytes / (thread_count * 2)));
+    }
+    std::vector<size_t> bounds;
+    {
+        StageTimer timer(MetricStage::SPLIT);
+        bounds = splitAtNewlines(text, range_bytes);
+    }
+    size_t range_count = bounds.size() - 1;
+    size_t window = max_pending_bytes ? std::max<size_t>(thread_count, max_pending_bytes / range_bytes) : range_count;
+    
+    std::vector<std::optional<RangeResult<Batch>>> results(range_count);
+    std::mutex results_mutex;
+    std::condition_variable range_done;
+    std::condition_variable window_moved;
+    std::atomic<size_t> next_range{0};
+    size_t stitched = 0;   // Ranges taken by the stitcher, under results_mutex
+    
+    auto worker = [&]() {
+        for (size_t r = next_range++; r < range_count; r = next_range++) {
+            if (window < range_count) {
+                std::unique_lock<std::mutex> lock(results_mutex);
+                window_moved.wait(lock, [&] { return r < stitched + window; });
+            }
+            
+            std::string_view range = text.substr(bounds[r], bounds[r + 1] - bounds[r]);
+            Batch batch(range.size());
+            size_t lines = 0;
+            
+            // Cancelled ranges are still marked done so the stitcher never blocks
+            if (!stop_requested) {
+                StageTimer timer(MetricStage::PARSE);
+                lines = parseInto(range, schema, batch);
+                timer.addItems(batch.size());
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(results_mutex);
+                results[r] = RangeResult<Batch>{std::move(batch), lines, true};
+            }
+            range_done.notify_all();
+        }
+    };
+    
+    std::vector<std::thread> workers;
+    size_t worker_count = std::min<size_t>(thread_count, range_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(worker);
+    }
+    
+    // Stitch results back together in file order
+    for (size_t r = 0; r < range_count; ++r) {
+        std::optional<RangeResult<Batch>> result;
+        {
+            std::unique_lock<std::mutex> lock(results_mutex);
+            range_done.wait(lock, [&] { return results[r].has_value(); });
+            result.swap(results[r]);
+            stitched = r + 1;
+        }
+        window_moved.notify_all();
+        if (!stop_requested) {
+            on_range(result->batch, result->lines, bounds[r + 1]);
+        }
+    }
+    
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+// Parse a stream line by line, handing a Batch to on_batch(batch, lines,
+// bytes_done) for every BATCH_BYTES of input. Used for inputs that can't be mapped.
+template <typename Batch, typename BatchCallback>
+static void parseStream(std::istream& input, LogSchemaId schema, const std::atomic<bool>& stop_requested,
+                        BatchCallback&& on_batch) {
+    // Large enough that appends and their locking are a small share of the
+    // parse, small enough that rows appear soon after the load starts
+    const size_t BATCH_BYTES = 1024 * 1024;
+    std::string line;
+    Batch batch;
+    size_t lines = 0;
+    size_t batch_bytes = 0;
+    uint64_t batch_start = metricsNow();
+    
+    while (std::getline(input, line) && !stop_requested) {
+        lines++;
+        batch_bytes += line.size() + 1;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        
+        LogEntryView view;
+        if (parseLogLine(line, view, schema)) {
+            batch.add(view);
+        }
+        
+        if (batch_bytes >= BATCH_BYTES) {
+            recordStage(MetricStage::PARSE, batch_start, metricsNow() - batch_start, batch.size());
+            std::streamoff bytes_done = input.tellg();
+            on_batch(batch, lines, bytes_done > 0 ? static_cast<size_t>(bytes_done) : 0);
+            batch = Batch();
+            lines = 0;
+            batch_bytes = 0;
+            batch_start = metricsNow();
+        }
+    }
+    
+    if (!stop_requested) {
+        recordStage(MetricStage::PARSE, batch_start, metricsNow() - batch_start, batch.size());
+        std::streamoff bytes_done = input.tellg();
+        on_batch(batch, lines, bytes_done > 0 ? static_cast<size_t>(bytes_done) : 0);
+    }
+}
+
+// Decompress file_path and hand its text to on_text(text, compressed_done,
+// compressed_total) in order, always ending at a line boundary. on_text
+// returns false to stop. Returns false if the file can't be opened or
+// decompressed.
+template <typename TextCallback>
+static bool readCompressed(const std::string& file_path, unsigned thread_count,
+                           const std::atomic<bool>& stop_requested, TextCallback&& on_text) {
+    CompressedFile file;
+    if (!file.open(file_path, thread_count)) {
+        return false;
+    }
+    
+    // A partial last line is carried over to the front of the next chunk
+    std::string chunk;
+    std::string text;
+    bool stopped = false;
+    auto read_chunk = [&] {
+        StageTimer timer(MetricStage::READ);
+        bool read = file.read(chunk);
+        timer.addItems(chunk.size());
+        return read;
+    };
+    while (!stopped && !stop_requested && read_chunk()) {
+        if (text.empty()) {
+            text.swap(chunk);
+        } else {
+            text += chunk;
+        }
+        size_t last_newline = text.rfind('\n');
+        size_t complete = last_newline == std::string::npos ? 0 : last_newline + 1;
+        stopped = !on_text(std::string_view(text).substr(0, complete), file.bytesConsumed(), file.size());
+        text.erase(0, complete);
+    }
+    if (!stopped && !stop_requested && !text.empty()) {
+        on_text(std::string_view(text), file.size(), file.size());
+    }
+    return !file.failed();
+}
+
+// Parse file_path into Batches handed to on_batch(batch) in file order.
+// Regular files are mapped and parsed in parallel; compressed files are
+// decompressed in the background and parsed in parallel a chunk at a time;
+// anything that can't be mapped falls back to reading line by line.
+// Returns false if the file can't be opened.
+//
+// With complete_bytes, a trailing line without its newline is left
+// unparsed and *complete_bytes is set to where it starts, so a follower can
+// pick it up once it's finished. Streamed and compressed inputs set it to npos.
+template <typename Batch, typename BatchCallback>
+static bool parseFileBatches(const std::string& file_path, unsigned thread_count, LogSchemaId schema,
+                             const std::atomic<bool>& stop_requested,
+                             const LogParser::ProgressCallback& progress_callback,
+                             size_t& total_lines, size_t* complete_bytes, BatchCallback&& on_batch) {
+    ProgressThrottle throttle;
+    auto on_range = [&](Batch& batch, size_t lines, size_t bytes_done, size_t total_bytes) {
+        on_batch(batch);
+        total_lines += lines;
+        if (throttle.due()) {
+            progress_callback(progressMessage(bytes_done, total_bytes, total_lines));
+        }
+    };
+    
+    if (detectCompression(file_path) != Compression::NONE) {
+        if (complete_bytes) {
+            *complete_bytes = std::string::npos;
+        }
+        progress_callback("Starting parse... 0%");
+        return readCompressed(file_path, thread_count, stop_requested,
+            [&](std::string_view text, size_t compressed_done, size_t compressed_total) {
+                parseParallel<Batch>(text, thread_count, schema, stop_requested,
+                    [&](Batch& batch, size_t lines, size_t) {
+                        on_range(batch, lines, compressed_done, compressed_total);
+                    });
+                return true;
+            });
+    }
+    
+    MappedFile mapped_file;
+    if (mapped_file.open(file_path)) {
+        std::string_view text = mapped_file.view();
+        if (complete_bytes) {
+            size_t last_newline = text.rfind('\n');
+            text = text.substr(0, last_newline == std::string_view::npos ? 0 : last_newline + 1);
+            *complete_bytes = text.size();
+        }
+        progress_callback("Starting parse... 0%");
+        parseParallel<Batch>(text, thread_count, schema, stop_requested,
+            [&](Batch& batch, size_t lines, size_t bytes_done) {
+                on_range(batch, lines, bytes_done, text.size());
+            });
+        return true;
+    }
+    
+    std::ifstream file(file_path);
+    if (!file.is_open()) {
+        return false;
+    }
     
-    std::ostringstream oss;
+    if (complete_bytes) {
+        *complete_bytes = std::string::npos;
+    }
+    
+    std::error_code size_error;
+    size_t file_size = static_cast<size_t>(std::filesystem::file_size(file_path, size_error));
+    progress_callback("Starting parse... 0%");
+    parseStream<Batch>(file, schema, stop_requested,
+        [&](Batch& batch, size_t lines, size_t bytes_done) {
+            on_range(batch, lines, bytes_done, size_error ? 0 : file_size);
+        });
+    return true;
+}
+
+LogParser::~LogParser() {
+    stopParsing();
+}
+
+bool LogParser::parseEntries(const std::string& file_path, const EntryVisitor& on_entry) {
+    if (detectCompression(file_path) != Compression::NONE) {
+        std::atomic<bool> never_stop{false};
+        bool stopped = false;
+        auto visit = [&](const LogEntryView& entry) {
+            if (!stopped && !on_entry(entry)) {
+                stopped = true;
+            }
+        };
+        return readCompressed(file_path, thread_count, never_stop, [&](std::string_view text, size_t, size_t) {
+            StageTimer timer(MetricStage::PARSE);
+            size_t entries = 0;
+            parseLogText(text, [&](const LogEntryView& entry) {
+                entries++;
+                visit(entry);
+            }, schema);
+            timer.addItems(entries);
+            return !stopped;
+        });
+    }
     
-    // Windows-compatible time formatting
-    std::tm tm_buf;
-    std::tm* tm_ptr;
-#ifdef _WIN32
-    localtime_s(&tm_buf, &time_t);
-    tm_ptr = &tm_buf;
-#else
-    tm_ptr = std::localtime(&time_t);
-#endif
+    // A single thread is faster reading blocks than taking page faults
+    unsigned threads = thread_count ? thread_count : std::thread::hardware_concurrency();
+    MappedFile mapped_file;
+    if (threads <= 1 || !mapped_file.open(file_path)) {
+        std::ifstream file(file_path, std::ios::binary);
+        return file.is_open() && parseEntries(file, on_entry);
+    }
     
-    oss << "[" << std::put_time(tm_ptr, "%H:%M:%S") 
-        << "." << std::setfill('0') << std::setw(3) << ms << "]["
-        << level << "]: " << message << " | LogParser.cpp -> parse()" << std::endl;
+    // Entries are consumed as fast as on_entry takes them, with at most this
+    // much of the file parsed and waiting. Consumed text is dropped from
+    // memory, so the mapping doesn't make the whole file resident either.
+    const size_t MAX_PENDING_BYTES = 32 * 1024 * 1024;
+    std::atomic<bool> stopped{false};
+    size_t consumed = 0;
+    parseParallel<EntryListBatch>(mapped_file.view(), threads, schema, stopped,
+        [&](EntryListBatch& batch, size_t, size_t bytes_done) {
+            for (const LogEntryView& entry : batch.entries) {
+                if (!on_entry(entry)) {
+                    stopped = true;
+                    return;
+                }
+            }
+            mapped_file.release(consumed, bytes_done - consumed);
+            consumed = bytes_done;
+        }, MAX_PENDING_BYTES);
+    return true;
+}
+
+bool LogParser::parseEntries(std::istream& input, const EntryVisitor& on_entry) {
+    // Whole lines of each block are parsed; a partial last line is carried
+    // into the next block (which grows only if a single line outgrows it)
+    const size_t BLOCK_SIZE = 4 * 1024 * 1024;
+    std::string buffer;
+    size_t carried = 0;
+    bool stopped = false;
+    size_t entries = 0;
+    auto visit = [&](const LogEntryView& entry) {
+        entries++;
+        if (!stopped && !on_entry(entry)) {
+            stopped = true;
+        }
+    };
     
-    logFile << oss.str();
-    logFile.flush();
+    while (!stopped) {
+        size_t bytes_read;
+        {
+            StageTimer timer(MetricStage::READ);
+            buffer.resize(carried + BLOCK_SIZE);
+            input.read(&buffer[carried], static_cast<std::streamsize>(BLOCK_SIZE));
+            bytes_read = static_cast<size_t>(input.gcount());
+            timer.addItems(bytes_read);
+        }
+        size_t size = carried + bytes_read;
+        bool at_end = bytes_read == 0;
+        
+        std::string_view text(buffer.data(), size);
+        size_t last_newline = text.rfind('\n');
+        size_t complete = at_end ? size : (last_newline == std::string_view::npos ? 0 : last_newline + 1);
+        {
+            StageTimer timer(MetricStage::PARSE);
+            size_t entries_before = entries;
+            parseLogText(text.substr(0, complete), visit, schema);
+            timer.addItems(entries - entries_before);
+        }
+        
+        carried = size - complete;
+        std::memmove(&buffer[0], &buffer[complete], carried);
+        if (at_end) break;
+    }
+    return !input.bad();
 }
 
 std::vector<LogEntry> LogParser::parse(const std::string& file_path) {
     std::vector<LogEntry> entries;
+    if (detectCompression(file_path) != Compression::NONE) {
+        if (!parseEntries(file_path, [&](const LogEntryView& view) {
+                entries.push_back(toLogEntry(view));
+                return true;
+            })) {
+            logDiagnostic(DiagnosticLevel::ERROR, "Error decompressing file: " + file_path);
+        }
+        return entries;
+    }
+    
     std::ifstream file(file_path);
     if (!file.is_open()) {
-        logToFile("ERROR", "Error opening file: " + file_path);
+        logDiagnostic(DiagnosticLevel::ERROR, "Error opening file: " + file_path);
         return entries;
     }
     
@@ -47,95 +479,29 @@ std::vector<LogEntry> LogParser::parse(const std::string& file_path) {
     std::streampos fileSize = file.tellg();
     file.seekg(0, std::ios::beg);
     
-    logToFile("INFO", "Starting to parse log file: " + file_path + " (" + std::to_string(fileSize) + " bytes)");
+    logDiagnostic(DiagnosticLevel::INFO, "Starting to parse log file: " + file_path + " (" + std::to_string(fileSize) + " bytes)");
 
     std::string line;
-    const char FIELD_SEPARATOR = 31; // ASCII field separator
-    
     int lineCount = 0;
     int matchedLines = 0;
-    std::streampos currentPos = 0;
 
+    // Progress is in the metrics rather than logged every few lines
+    uint64_t parse_start = metricsNow();
     while (std::getline(file, line)) {
         lineCount++;
-        currentPos = file.tellg();
         
-        // Log progress every 1000 lines
-        if (lineCount % 1000 == 0) {
-            int progress = (currentPos * 100) / fileSize;
-            logToFile("DEBUG", "Processed " + std::to_string(lineCount) + " lines, " + 
-                     std::to_string(matchedLines) + " matches (" + std::to_string(progress) + "%)");
-        }
-        
-        // Parse line using field separators: timestamp<FS>level<FS>message<FS>source_info
-        std::vector<std::string> fields;
-        std::string field;
-        
-        for (char c : line) {
-            if (c == FIELD_SEPARATOR) {
-                fields.push_back(field);
-                field.clear();
-            } else {
-                field += c;
-            }
-        }
-        if (!field.empty()) {
-            fields.push_back(field); // Add the last field
-        }
-        
-        // Expected format: timestamp, level, message, source_info
-        if (fields.size() >= 4) {
-            LogEntry entry;
-            entry.timestamp = fields[0];
-            
-            // Parse level (trim whitespace)
-            std::string level_str = fields[1];
-            // Remove leading/trailing whitespace
-            level_str.erase(0, level_str.find_first_not_of(" \t"));
-            level_str.erase(level_str.find_last_not_of(" \t") + 1);
-            
-            if (level_str == "DEBUG") {
-                entry.level = LogLevel::DEBUG;
-            } else if (level_str == "INFO") {
-                entry.level = LogLevel::INFO;
-            } else if (level_str == "WARN") {
-                entry.level = LogLevel::WARN;
-            } else if (level_str == "ERROR") {
-                entry.level = LogLevel::ERROR;
-            } else if (level_str == "FOOTER") {
-                entry.level = LogLevel::FOOTER;
-            } else if (level_str == "HEADER") {
-                entry.level = LogLevel::HEADER;
-            } else {
-                entry.level = LogLevel::DEBUG; // Default fallback
-            }
-            
-            entry.message = fields[2];
-            
-            // Parse source info: "source_file -> function(): line_number"
-            std::string source_info = fields[3];
-            std::regex source_re(R"((.*)\s*->\s*(.*)\(\):\s*(\d+))");
-            std::smatch source_match;
-            if (std::regex_match(source_info, source_match, source_re)) {
-                entry.source_file = source_match[1];
-                entry.source_function = source_match[2];
-                entry.source_line = std::stoi(source_match[3]);
-            } else {
-                // Fallback if source info doesn't match expected format
-                entry.source_file = source_info;
-                entry.source_function = "unknown";
-                entry.source_line = 0;
-            }
-            
-            entries.push_back(entry);
+        LogEntryView view;
+        if (parseLogLine(line, view, schema)) {
+            entries.push_back(toLogEntry(view));
             matchedLines++;
         }
         // Silently skip lines that don't have enough fields
     }
+    recordStage(MetricStage::PARSE, parse_start, metricsNow() - parse_start, entries.size());
     
-    logToFile("INFO", "Processed " + std::to_string(lineCount) + " total lines, " + std::to_string(matchedLines) + " matched");
+    logDiagnostic(DiagnosticLevel::INFO, "Processed " + std::to_string(lineCount) + " total lines, " + std::to_string(matchedLines) + " matched");
     
-    logToFile("INFO", "Finished parsing log file. Found " + std::to_string(entries.size()) + " valid entries");
+    logDiagnostic(DiagnosticLevel::INFO, "Finished parsing log file. Found " + std::to_string(entries.size()) + " valid entries");
     return entries;
 }
 
@@ -146,156 +512,573 @@ void LogParser::parseAsync(const std::string& file_path,
     // Stop any existing parsing
     stopParsing();
     
+    // Set state before the thread starts so an immediate stopParsing() isn't lost
+    parsing_active = true;
+    stop_requested = false;
+    
     // Start new parsing thread
     parsing_thread = std::thread([this, file_path, &entries, &entries_mutex, progress_callback]() {
-        parsing_active = true;
-        stop_requested = false;
+        size_t total_lines = 0;
+        bool opened = parseFileBatches<OwnedBatch>(file_path, thread_count, schema, stop_requested,
+                                                   progress_callback, total_lines, nullptr,
+            [&](OwnedBatch& batch) {
+                std::lock_guard<std::mutex> lock(entries_mutex);
+                entries.insert(entries.end(), std::make_move_iterator(batch.entries.begin()),
+                               std::make_move_iterator(batch.entries.end()));
+            });
         
-        std::ifstream file(file_path);
-        if (!file.is_open()) {
+        if (!opened) {
+            logDiagnostic(DiagnosticLevel::ERROR, "Error opening file: " + file_path);
             progress_callback("Error: Could not open file");
             parsing_active = false;
             return;
         }
+        finishAsync(total_lines, entries_mutex, [&] { return entries.size(); }, progress_callback);
+    });
+}
+
+void LogParser::parseAsync(const std::string& file_path,
+                          LogStore& store,
+                          std::mutex& store_mutex,
+                          ProgressCallback progress_callback) {
+    // Stop any existing parsing
+    stopParsing();
+    
+    parsing_active = true;
+    stop_requested = false;
+    
+    parsing_thread = std::thread([this, file_path, &store, &store_mutex, progress_callback]() {
+        size_t total_lines = 0;
+        bool opened = parseFileBatches<CopiedBatch>(file_path, thread_count, schema, stop_requested,
+                                                    progress_callback, total_lines, nullptr,
+            [&](CopiedBatch& batch) {
+                std::lock_guard<std::mutex> lock(store_mutex);
+                store.append(std::move(batch));
+            });
         
-        // Get file size for progress tracking
-        auto file_size = std::filesystem::file_size(file_path);
-        progress_callback("Starting parse... 0%");
+        if (!opened) {
+            logDiagnostic(DiagnosticLevel::ERROR, "Error opening file: " + file_path);
+            progress_callback("Error: Could not open file");
+            parsing_active = false;
+            return;
+        }
+        finishAsync(total_lines, store_mutex, [&] { return store.size(); }, progress_callback);
+    });
+}
+
+void LogParser::followAsync(const std::string& file_path,
+                           LogStore& store,
+                           std::mutex& store_mutex,
+                           ProgressCallback progress_callback) {
+    // Stop any existing parsing
+    stopParsing();
+    
+    parsing_active = true;
+    stop_requested = false;
+    
+    parsing_thread = std::thread([this, file_path, &store, &store_mutex, progress_callback]() {
+        size_t total_lines = 0;
+        size_t complete_bytes = 0;
+        bool opened = parseFileBatches<CopiedBatch>(file_path, thread_count, schema, stop_requested,
+                                                    progress_callback, total_lines, &complete_bytes,
+            [&](CopiedBatch& batch) {
+                std::lock_guard<std::mutex> lock(store_mutex);
+                store.append(std::move(batch));
+            });
         
-        std::string line;
-        std::vector<std::string> line_batch;
-        const int BATCH_SIZE = 5000;
-        int total_lines = 0;
-        int total_matched = 0;
-        std::streampos current_pos = 0;
+        if (!opened) {
+            logDiagnostic(DiagnosticLevel::ERROR, "Error opening file: " + file_path);
+            progress_callback("Error: Could not open file");
+            parsing_active = false;
+            return;
+        }
+        finishAsync(total_lines, store_mutex, [&] { return store.size(); }, progress_callback);
         
-        while (std::getline(file, line) && !stop_requested) {
-            line_batch.push_back(line);
-            total_lines++;
-            
-            // Process batch when we reach BATCH_SIZE
-            if (line_batch.size() >= BATCH_SIZE) {
-                parseChunk(line_batch, entries, entries_mutex);
-                
-                // Update progress
-                current_pos = file.tellg();
-                int progress = (current_pos * 100) / file_size;
-                std::string status = "Parsing... " + std::to_string(progress) + "% (" + 
-                                   std::to_string(total_lines) + " lines)";
-                progress_callback(status);
-                
-                line_batch.clear();
-                
-                // Small delay to prevent UI blocking
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
+        // Pipes and devices have no end to follow
+        if (!stop_requested && complete_bytes != std::string::npos) {
+            following = true;
+            followFile(file_path, complete_bytes, store, store_mutex, progress_callback);
+            following = false;
+        }
+    });
+}
+
+void LogParser::followFile(const std::string& file_path, size_t offset,
+                           LogStore& store, std::mutex& store_mutex,
+                           const ProgressCallback& progress_callback) {
+    // Upper bound on how long stopParsing() waits for an idle follower
+    const int POLL_INTERVAL_MS = 100;
+    
+    FileFollower follower;
+    if (!follower.open(file_path, offset)) {
+        logDiagnostic(DiagnosticLevel::ERROR, "Error reopening file to follow: " + file_path);
+        progress_callback("Error: Could not reopen file to follow");
+        return;
+    }
+    
+    // Bursts of appends report at the throttled rate; the last one is sent
+    // as soon as the file goes quiet
+    ProgressThrottle throttle;
+    bool status_pending = false;
+    auto status = [&](const std::string& prefix) {
+        status_pending = false;
+        size_t entries;
+        {
+            std::lock_guard<std::mutex> lock(store_mutex);
+            entries = store.size();
+        }
+        progress_callback(prefix + std::to_string(entries) + " entries");
+    };
+    
+    // Parse complete lines of text into the store
+    auto append_text = [&](std::string_view text) {
+        parseParallel<CopiedBatch>(text, thread_count, schema, stop_requested,
+            [&](CopiedBatch& batch, size_t, size_t) {
+                std::lock_guard<std::mutex> lock(store_mutex);
+                store.append(std::move(batch));
+            });
+    };
+    
+    status("Following: ");
+    
+    // Bytes after the last newline, waiting for the rest of their line
+    std::string pending;
+    while (!stop_requested) {
+        // Idle polls aren't reads worth timing
+        uint64_t read_start = metricsNow();
+        size_t pending_before = pending.size();
+        FileFollower::Change change = follower.read(pending);
+        if (change != FileFollower::Change::NONE) {
+            recordStage(MetricStage::READ, read_start, metricsNow() - read_start,
+                        pending.size() > pending_before ? pending.size() - pending_before : 0);
         }
         
-        // Process remaining lines
-        if (!line_batch.empty() && !stop_requested) {
-            parseChunk(line_batch, entries, entries_mutex);
+        if (change == FileFollower::Change::TRUNCATED || change == FileFollower::Change::ROTATED) {
+            // The old file's last line won't be continued
+            append_text(pending);
+            pending.clear();
+            status(change == FileFollower::Change::TRUNCATED ? "File truncated, following from the start: "
+                                                             : "File rotated, following the new file: ");
+            continue;
+        }
+        if (change == FileFollower::Change::NONE) {
+            if (status_pending) {
+                status("Following: ");
+            }
+            follower.wait(POLL_INTERVAL_MS);
+            continue;
         }
         
-        if (stop_requested) {
-            progress_callback("Parsing cancelled");
+        size_t last_newline = pending.rfind('\n');
+        if (last_newline == std::string::npos) continue;
+        append_text(std::string_view(pending).substr(0, last_newline + 1));
+        pending.erase(0, last_newline + 1);
+        if (throttle.due()) {
+            status("Following: ");
         } else {
-            // Get final count
-            {
-                std::lock_guard<std::mutex> lock(entries_mutex);
-                total_matched = entries.size();
-            }
-            progress_callback("Complete: " + std::to_string(total_matched) + " entries from " + 
-                            std::to_string(total_lines) + " lines");
+            status_pending = true;
+        }
+    }
+}
+
+void LogParser::listenAsync(const std::string& endpoint,
+                            LogStore& store,
+                            std::mutex& store_mutex,
+                            ProgressCallback progress_callback) {
+    // Stop any existing parsing
+    stopParsing();
+    
+    parsing_active = true;
+    stop_requested = false;
+    
+    parsing_thread = std::thread([this, endpoint, &store, &store_mutex, progress_callback]() {
+        SocketListener listener;
+        std::string error;
+        if (!listener.open(endpoint, error)) {
+            logDiagnostic(DiagnosticLevel::ERROR, "Error listening on " + endpoint + ": " + error);
+            progress_callback("Error: Could not listen on " + endpoint + " (" + error + ")");
+            parsing_active = false;
+            return;
         }
+        logDiagnostic(DiagnosticLevel::INFO, "Listening for log streams on " + listener.address());
         
+        // There's no initial load; everything is followed
         parsing_active = false;
+        following = true;
+        receiveStreams(listener, store, store_mutex, progress_callback);
+        following = false;
     });
 }
 
-void LogParser::parseChunk(const std::vector<std::string>& lines,
-                          std::vector<LogEntry>& entries,
-                          std::mutex& entries_mutex) {
-    const char FIELD_SEPARATOR = 31; // ASCII field separator
-    std::vector<LogEntry> chunk_entries;
-    std::regex source_re(R"((.*)\s*->\s*(.*)\(\):\s*(\d+))");
+void LogParser::receiveStreams(SocketListener& listener, LogStore& store, std::mutex& store_mutex,
+                               const ProgressCallback& progress_callback) {
+    // Upper bound on how long stopParsing() waits, and on how long a
+    // paused ingest takes to notice the viewer caught up
+    const int POLL_INTERVAL_MS = 100;
     
-    for (const auto& line : lines) {
-        if (stop_requested) break;
-        
-        // Parse line using field separators: timestamp<FS>level<FS>message<FS>source_info
-        std::vector<std::string> fields;
-        std::string field;
+    // Origin of each sending host, so a node that reconnects keeps its own
+    std::unordered_map<std::string, uint16_t> origins;
+    
+    ProgressThrottle throttle;
+    bool status_pending = false;
+    bool paused = false;
+    auto status = [&] {
+        status_pending = false;
+        size_t connections = listener.connections().size();
+        std::string message = "Listening on " + listener.address() + ": " + std::to_string(connections) +
+                              (connections == 1 ? " connection, " : " connections, ") +
+                              std::to_string(store.size()) + " entries";
+        progress_callback(paused ? message + " (paused, the view is behind)" : message);
+    };
+    
+    status();
+    while (!stop_requested) {
+        // Only this thread appends, so the size needs no lock
+        size_t rows = store.size();
+        size_t viewed = viewed_rows.load(std::memory_order_relaxed);
+        bool behind = viewed != SIZE_MAX && rows > viewed && rows - viewed > MAX_UNVIEWED_ROWS;
+        if (behind != paused) {
+            paused = behind;
+            logDiagnostic(DiagnosticLevel::DEBUG, paused ? "Ingest paused for the view" : "Ingest resumed");
+            status_pending = true;
+        }
         
-        for (char c : line) {
-            if (c == FIELD_SEPARATOR) {
-                fields.push_back(field);
-                field.clear();
-            } else {
-                field += c;
+        uint64_t read_start = metricsNow();
+        uint64_t bytes_before = listener.bytesReceived();
+        if (!listener.poll(POLL_INTERVAL_MS, !paused)) {
+            if (status_pending) {
+                status();
             }
+            continue;
         }
-        if (!field.empty()) {
-            fields.push_back(field); // Add the last field
+        if (listener.bytesReceived() > bytes_before) {
+            recordStage(MetricStage::READ, read_start, metricsNow() - read_start,
+                        listener.bytesReceived() - bytes_before);
         }
         
-        // Expected format: timestamp, level, message, source_info
-        if (fields.size() >= 4) {
-            LogEntry entry;
-            entry.timestamp = fields[0];
-            
-            // Parse level (trim whitespace)
-            std::string level_str = fields[1];
-            // Remove leading/trailing whitespace
-            level_str.erase(0, level_str.find_first_not_of(" \\t"));
-            level_str.erase(level_str.find_last_not_of(" \\t") + 1);
-            
-            if (level_str == "DEBUG") {
-                entry.level = LogLevel::DEBUG;
-            } else if (level_str == "INFO") {
-                entry.level = LogLevel::INFO;
-            } else if (level_str == "WARN") {
-                entry.level = LogLevel::WARN;
-            } else if (level_str == "ERROR") {
-                entry.level = LogLevel::ERROR;
-            } else if (level_str == "FOOTER") {
-                entry.level = LogLevel::FOOTER;
-            } else if (level_str == "HEADER") {
-                entry.level = LogLevel::HEADER;
-            } else {
-                entry.level = LogLevel::DEBUG; // Default fallback
+        for (SocketListener::Connection& connection : listener.connections()) {
+            // Complete lines only, unless the sender is gone or a line fills
+            // the whole buffer, which is parsed cut rather than waited on
+            std::string& received = connection.received;
+            size_t last_newline = received.rfind('\n');
+            size_t end = last_newline == std::string::npos ? 0 : last_newline + 1;
+            if (connection.closed || (end == 0 && received.size() >= SocketListener::MAX_BUFFERED)) {
+                end = received.size();
             }
+            if (end == 0) continue;
             
-            entry.message = fields[2];
-            
-            // Parse source info: "source_file -> function(): line_number"
-            std::string source_info = fields[3];
-            std::smatch source_match;
-            if (std::regex_match(source_info, source_match, source_re)) {
-                entry.source_file = source_match[1];
-                entry.source_function = source_match[2];
-                entry.source_line = std::stoi(source_match[3]);
-            } else {
-                // Fallback if source info doesn't match expected format
-                entry.source_file = source_info;
-                entry.source_function = "unknown";
-                entry.source_line = 0;
+            auto known = origins.find(connection.peer);
+            if (known == origins.end()) {
+                std::lock_guard<std::mutex> lock(store_mutex);
+                known = origins.emplace(connection.peer, store.addOrigin(connection.peer)).first;
+                logDiagnostic(DiagnosticLevel::INFO, "Receiving log stream from " + connection.peer);
             }
             
-            chunk_entries.push_back(entry);
+            CopiedBatch batch;
+            {
+                StageTimer timer(MetricStage::PARSE);
+                parseInto(std::string_view(received).substr(0, end), schema, batch);
+                timer.addItems(batch.size());
+            }
+            batch.setOrigin(known->second);
+            {
+                std::lock_guard<std::mutex> lock(store_mutex);
+                store.append(std::move(batch));
+            }
+            received.erase(0, end);
         }
+        listener.removeClosed();
+        
+        if (throttle.due()) {
+            status();
+        } else {
+            status_pending = true;
+        }
+    }
+}
+
+bool LogParser::parseMapped(const std::string& file_path, LogStore& store) {
+    // Compressed text has nothing to map, so it's copied into the store
+    if (detectCompression(file_path) != Compression::NONE) {
+        store.clear();
+        std::atomic<bool> never_stop{false};
+        size_t line_count = 0;
+        return parseFileBatches<CopiedBatch>(file_path, thread_count, schema, never_stop, [](const std::string&) {},
+                                             line_count, nullptr, [&](CopiedBatch& batch) {
+            store.append(std::move(batch));
+        });
+    }
+    
+    if (!store.map(file_path, lazy_decoding, schema)) {
+        logDiagnostic(DiagnosticLevel::ERROR, "Error mapping file: " + file_path);
+        return false;
     }
     
-    // Add chunk to main entries with mutex protection
+    std::string_view text = store.text();
+    logDiagnostic(DiagnosticLevel::INFO, "Starting to parse mapped log file: " + file_path + " (" + std::to_string(text.size()) + " bytes)");
+    
+    // Resume from the on-disk cache, then parse whatever it doesn't cover
+    size_t line_count = 0;
+    bool use_cache = use_index_cache && !lazy_decoding;
+    size_t cached_bytes = use_cache ? loadIndexCache(file_path, store, line_count) : 0;
+    
+    // Synchronous parsing runs to completion regardless of stopParsing()
+    std::atomic<bool> never_stop{false};
+    auto on_range = [&](LogBatch& batch, size_t lines, size_t) {
+        store.append(std::move(batch));
+        line_count += lines;
+    };
+    if (lazy_decoding) {
+        parseParallel<LazyBatch>(text, thread_count, schema, never_stop, on_range);
+    } else {
+        parseParallel<ViewBatch>(text.substr(cached_bytes), thread_count, schema, never_stop, on_range);
+    }
+    
+    if (use_cache && cached_bytes < text.size()) {
+        if (!saveIndexCache(file_path, store, line_count)) {
+            logDiagnostic(DiagnosticLevel::WARN, "Could not write index cache for " + file_path);
+        }
+    }
+    
+    logDiagnostic(DiagnosticLevel::INFO, "Finished parsing mapped log file. Found " + std::to_string(store.size()) + 
+              " valid entries from " + std::to_string(line_count) + " lines" +
+              (cached_bytes ? " (" + std::to_string(cached_bytes) + " bytes from the index cache)" : ""));
+    return true;
+}
+
+void LogParser::parseMappedAsync(const std::string& file_path,
+                                LogStore& store,
+                                std::mutex& store_mutex,
+                                ProgressCallback progress_callback) {
+    // Compressed text has nothing to map, so it's copied into the store
+    if (detectCompression(file_path) != Compression::NONE) {
+        parseAsync(file_path, store, store_mutex, std::move(progress_callback));
+        return;
+    }
+    
+    // Stop any existing parsing
+    stopParsing();
+    
+    // Remap on the caller's thread so readers holding views never see the
+    // mapping swapped out from under them
+    bool mapped;
     {
-        std::lock_guard<std::mutex> lock(entries_mutex);
-        entries.insert(entries.end(), chunk_entries.begin(), chunk_entries.end());
+        std::lock_guard<std::mutex> lock(store_mutex);
+        mapped = store.map(file_path, lazy_decoding, schema);
+    }
+    if (!mapped) {
+        logDiagnostic(DiagnosticLevel::ERROR, "Error mapping file: " + file_path);
+        progress_callback("Error: Could not open file");
+        return;
     }
+    
+    parsing_active = true;
+    stop_requested = false;
+    
+    parsing_thread = std::thread([this, file_path, &store, &store_mutex, progress_callback]() {
+        std::string_view text = store.text();
+        
+        // Resume from the on-disk cache, then parse whatever it doesn't cover.
+        // Lazy stores are cheap to rebuild and have no cached form.
+        size_t total_lines = 0;
+        size_t cached_bytes = 0;
+        bool use_cache = use_index_cache && !lazy_decoding;
+        if (use_cache) {
+            progress_callback("Loading index cache...");
+            std::lock_guard<std::mutex> lock(store_mutex);
+            cached_bytes = loadIndexCache(file_path, store, total_lines);
+        }
+        if (diagnosticEnabled(DiagnosticLevel::DEBUG)) {
+            logDiagnostic(DiagnosticLevel::DEBUG, "Mapped " + file_path + ": " + std::to_string(text.size()) +
+                          " bytes, " + std::to_string(cached_bytes) + " from the index cache");
+        }
+        progress_callback(progressMessage(cached_bytes, text.size(), total_lines));
+        
+        ProgressThrottle throttle;
+        auto on_range = [&](LogBatch& batch, size_t lines, size_t bytes_done) {
+            {
+                std::lock_guard<std::mutex> lock(store_mutex);
+                store.append(std::move(batch));
+            }
+            total_lines += lines;
+            if (throttle.due()) {
+                progress_callback(progressMessage(cached_bytes + bytes_done, text.size(), total_lines));
+            }
+        };
+        if (lazy_decoding) {
+            parseParallel<LazyBatch>(text, thread_count, schema, stop_requested, on_range);
+        } else {
+            parseParallel<ViewBatch>(text.substr(cached_bytes), thread_count, schema, stop_requested, on_range);
+        }
+        
+        // A cancelled parse leaves the store incomplete, so nothing is cached
+        if (use_cache && !stop_requested && cached_bytes < text.size()) {
+            progress_callback("Writing index cache...");
+            if (!saveIndexCache(file_path, store, total_lines)) {
+                logDiagnostic(DiagnosticLevel::WARN, "Could not write index cache for " + file_path);
+            }
+        }
+        
+        finishAsync(total_lines, store_mutex, [&] { return store.size(); }, progress_callback);
+    });
+}
+
+// Rows per batch appended to a merged store
+static const size_t MERGE_BATCH_ROWS = 64 * 1024;
+
+// Map file_paths into store for a merge, with the reason if that fails
+static bool mapMergeInputs(const std::vector<std::string>& file_paths, LogStore& store, std::string& error) {
+    for (const std::string& path : file_paths) {
+        if (detectCompression(path) != Compression::NONE) {
+            error = "Error: Compressed files can't be merged: " + path;
+            return false;
+        }
+    }
+    if (!store.mapMerged(file_paths)) {
+        error = "Error: Could not open all " + std::to_string(file_paths.size()) + " files";
+        return false;
+    }
+    return true;
+}
+
+// Merge the texts of a mapped merged store, calling on_batch(batch, total_rows)
+// for every batch of rows in merged order
+template <typename BatchCallback>
+static bool mergeInto(const LogStore& store, LogSchemaId schema, const std::atomic<bool>& stop_requested,
+                      BatchCallback&& on_batch) {
+    std::vector<std::string_view> texts;
+    for (size_t origin = 0; origin < store.originCount(); ++origin) {
+        texts.push_back(store.originText(origin));
+    }
+    
+    ViewBatch batch;
+    size_t merged_rows = 0;
+    bool completed = mergeLogs(texts, schema, stop_requested, [&](const LogEntryView& entry, int32_t time, size_t origin) {
+        batch.add(entry, time, static_cast<uint16_t>(origin));
+        if (batch.size() >= MERGE_BATCH_ROWS) {
+            merged_rows += batch.size();
+            on_batch(batch, merged_rows);
+            batch = ViewBatch();
+        }
+        return true;
+    });
+    if (batch.size() > 0) {
+        merged_rows += batch.size();
+        on_batch(batch, merged_rows);
+    }
+    return completed;
+}
+
+bool LogParser::parseMerged(const std::vector<std::string>& file_paths, LogStore& store) {
+    std::string error;
+    if (!mapMergeInputs(file_paths, store, error)) {
+        logDiagnostic(DiagnosticLevel::ERROR, error);
+        return false;
+    }
+    
+    // Synchronous parsing runs to completion regardless of stopParsing()
+    std::atomic<bool> never_stop{false};
+    mergeInto(store, schema, never_stop, [&](LogBatch& batch, size_t) { store.append(std::move(batch)); });
+    
+    logDiagnostic(DiagnosticLevel::INFO, "Finished merging " + std::to_string(file_paths.size()) + " log files. Found " +
+              std::to_string(store.size()) + " valid entries");
+    return true;
+}
+
+void LogParser::parseMergedAsync(const std::vector<std::string>& file_paths,
+                                 LogStore& store,
+                                 std::mutex& store_mutex,
+                                 ProgressCallback progress_callback) {
+    // Stop any existing parsing
+    stopParsing();
+    
+    // Map on the caller's thread, as parseMappedAsync() does
+    std::string error;
+    bool mapped;
+    {
+        std::lock_guard<std::mutex> lock(store_mutex);
+        mapped = mapMergeInputs(file_paths, store, error);
+    }
+    if (!mapped) {
+        logDiagnostic(DiagnosticLevel::ERROR, error);
+        progress_callback(error);
+        return;
+    }
+    
+    parsing_active = true;
+    stop_requested = false;
+    
+    parsing_thread = std::thread([this, &store, &store_mutex, progress_callback]() {
+        std::string files = std::to_string(store.originCount()) + " files";
+        progress_callback("Merging " + files + "...");
+        
+        ProgressThrottle throttle;
+        mergeInto(store, schema, stop_requested, [&](LogBatch& batch, size_t merged_rows) {
+            {
+                std::lock_guard<std::mutex> lock(store_mutex);
+                store.append(std::move(batch));
+            }
+            if (throttle.due()) {
+                progress_callback("Merging " + files + "... (" + std::to_string(merged_rows) + " entries)");
+            }
+        });
+        
+        if (stop_requested) {
+            progress_callback("Parsing cancelled");
+        } else {
+            progress_callback("Complete: " + std::to_string(store.size()) + " entries merged from " + files);
+        }
+        parsing_active = false;
+    });
+}
+
+void LogParser::finishAsync(size_t total_lines, std::mutex& entries_mutex,
+                            const std::function<size_t()>& entry_count,
+                            const ProgressCallback& progress_callback) {
+    if (stop_requested) {
+        progress_callback("Parsing cancelled");
+    } else {
+        // Get final count
+        size_t total_matched;
+        {
+            std::lock_guard<std::mutex> lock(entries_mutex);
+            total_matched = entry_count();
+        }
+        progress_callback("Complete: " + std::to_string(total_matched) + " entries from " + 
+                          std::to_string(total_lines) + " lines");
+    }
+    
+    parsing_active = false;
+}
+
+void LogParser::setThreadCount(unsigned count) {
+    thread_count = count;
+}
+
+void LogParser::setIndexCacheEnabled(bool enabled) {
+    use_index_cache = enabled;
+}
+
+void LogParser::setLazyDecoding(bool enabled) {
+    lazy_decoding = enabled;
+}
+
+void LogParser::setSchema(LogSchemaId new_schema) {
+    schema = new_schema;
+}
+
+void LogParser::setViewedRows(size_t rows) {
+    viewed_rows.store(rows, std::memory_order_relaxed);
 }
 
 bool LogParser::isParsingInProgress() const {
     return parsing_active;
 }
 
+bool LogParser::isFollowing() const {
+    return following;
+}
+
 void LogParser::stopParsing() {
     stop_requested = true;
     if (parsing_thread.joinable()) {
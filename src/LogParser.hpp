@@ -7,35 +7,161 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include "LineParser.hpp"
 #include "LogEntry.hpp"
+#include "LogStore.hpp"
+
+class SocketListener;
 
 class LogParser {
 public:
     using ProgressCallback = std::function<void(const std::string&)>;
     
+    // Called for each parsed entry; return false to stop parsing
+    using EntryVisitor = std::function<bool(const LogEntryView&)>;
+    
+    ~LogParser();
+    
     // Synchronous parsing (original method)
     std::vector<LogEntry> parse(const std::string& file_path);
     
+    // Every load path reads gzip and zstd files transparently (detected by
+    // their magic bytes), decompressing in the background, across cores for
+    // BGZF and multi-frame zstd. Compressed files are copied into stores
+    // even by the mapped parses, and can't be followed.
+    
+    // Streaming parse: call on_entry for every entry of file_path in file
+    // order, on the calling thread. Views are valid only during the call and
+    // nothing is kept, so memory use doesn't grow with the file; consumers
+    // that only aggregate never hold more than the entries in flight.
+    // Regular files are mapped and parsed in parallel, at most 32 MB ahead
+    // of on_entry; anything else is read in blocks. Returns false if the
+    // file can't be opened or read.
+    bool parseEntries(const std::string& file_path, const EntryVisitor& on_entry);
+    
+    // parseEntries() for a stream, such as std::cin
+    bool parseEntries(std::istream& input, const EntryVisitor& on_entry);
+    
     // Asynchronous parsing with progress updates
     void parseAsync(const std::string& file_path, 
                    std::vector<LogEntry>& entries,
                    std::mutex& entries_mutex,
                    ProgressCallback progress_callback);
     
-    // Check if async parsing is in progress
+    // Asynchronous parsing into store. Entry text is copied into per-load
+    // arenas owned by the store, so the file isn't held open afterwards.
+    void parseAsync(const std::string& file_path,
+                   LogStore& store,
+                   std::mutex& store_mutex,
+                   ProgressCallback progress_callback);
+    
+    // Memory-mapped parsing: entries in store are views into the mapping
+    bool parseMapped(const std::string& file_path, LogStore& store);
+    
+    // Asynchronous memory-mapped parsing. The file is mapped before this
+    // returns; entries are appended to store in batches under store_mutex.
+    //
+    // Both mapped parses reuse the file's on-disk index cache when it's
+    // current (or the file has only grown) and rewrite it afterwards.
+    void parseMappedAsync(const std::string& file_path,
+                         LogStore& store,
+                         std::mutex& store_mutex,
+                         ProgressCallback progress_callback);
+    
+    // Merge several files into one store ordered by timestamp, for logs
+    // written side by side by different processes. Each file is mapped and
+    // parsed on its own thread and the entries are k-way merged as they
+    // are parsed (see mergeLogs()), so rows are views into the mappings and
+    // nothing is concatenated. LogStore::origin() gives each row's file.
+    // Compressed files can't be merged.
+    bool parseMerged(const std::vector<std::string>& file_paths, LogStore& store);
+    
+    // Asynchronous parseMerged(). The files are mapped before this returns;
+    // entries are appended to store in batches under store_mutex.
+    void parseMergedAsync(const std::vector<std::string>& file_paths,
+                         LogStore& store,
+                         std::mutex& store_mutex,
+                         ProgressCallback progress_callback);
+    
+    // Like parseAsync into a store, then keep watching the file and parse
+    // lines as they are appended until stopParsing(). Truncated files are
+    // followed from their start and rotated ones from the new file, with
+    // the earlier entries kept. Text is always copied, since a mapping of
+    // a file that gets truncated can't be read safely.
+    void followAsync(const std::string& file_path,
+                    LogStore& store,
+                    std::mutex& store_mutex,
+                    ProgressCallback progress_callback);
+    
+    // Accept log streams from forwarders on endpoint (see SocketListener)
+    // and parse their lines into store as they arrive, until
+    // stopParsing(). Each sending host is an origin() of the store, kept
+    // when it reconnects; rows are kept in arrival order. Reading stops
+    // while the viewer is more than MAX_UNVIEWED_ROWS behind
+    // (setViewedRows()), so forwarders are slowed down by TCP flow control
+    // rather than entries queued in memory. Counts as following.
+    void listenAsync(const std::string& endpoint,
+                    LogStore& store,
+                    std::mutex& store_mutex,
+                    ProgressCallback progress_callback);
+    
+    // Rows the viewer has caught up with, for listenAsync()'s backpressure.
+    // Without calls to it, ingest never waits.
+    void setViewedRows(size_t rows);
+    
+    // Rows ingest may get ahead of setViewedRows()
+    static constexpr size_t MAX_UNVIEWED_ROWS = 1000000;
+    
+    // Check if async parsing is in progress. Follow mode counts as parsing
+    // only until the initial load completes.
     bool isParsingInProgress() const;
     
+    // Check if followAsync() is watching for appended lines
+    bool isFollowing() const;
+    
     // Stop async parsing
     void stopParsing();
+    
+    // Worker threads used by the parallel parse engine (0 = all cores)
+    void setThreadCount(unsigned count);
+    
+    // Read and write "<file>.lrindex" caches for mapped parses (on by default)
+    void setIndexCacheEnabled(bool enabled);
+    
+    // Make mapped parses build lazy stores: only line offsets, levels and
+    // times are recorded up front and the other fields are decoded when rows are read.
+    // The index cache isn't used for lazy stores. Off by default.
+    void setLazyDecoding(bool enabled);
+    
+    // Field layout of the lines of later parses (StandardSchema by default)
+    void setSchema(LogSchemaId schema);
 
 private:
     std::atomic<bool> parsing_active{false};
     std::atomic<bool> stop_requested{false};
+    std::atomic<bool> following{false};
+    std::atomic<size_t> viewed_rows{SIZE_MAX};
     std::thread parsing_thread;
+    unsigned thread_count = 0;
+    bool use_index_cache = true;
+    bool lazy_decoding = false;
+    LogSchemaId schema = LogSchemaId::STANDARD;
     
-    void parseChunk(const std::vector<std::string>& lines,
-                   std::vector<LogEntry>& entries,
-                   std::mutex& entries_mutex);
+    // Report cancellation or the final entry count and clear parsing_active
+    void finishAsync(size_t total_lines, std::mutex& entries_mutex,
+                     const std::function<size_t()>& entry_count,
+                     const ProgressCallback& progress_callback);
+    
+    // Parse lines appended to file_path from offset until stop_requested
+    void followFile(const std::string& file_path, size_t offset,
+                    LogStore& store, std::mutex& store_mutex,
+                    const ProgressCallback& progress_callback);
+    
+    // Parse the lines arriving on listener's connections until stop_requested
+    void receiveStreams(SocketListener& listener, LogStore& store, std::mutex& store_mutex,
+                        const ProgressCallback& progress_callback);
 };
 
 #endif // LOG_PARSER_HPP
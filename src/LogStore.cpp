@@ -0,0 +1,193 @@
+#include "LogStore.hpp"
+#include "LineParser.hpp"
+#include "Metrics.hpp"
+
+uint32_t StringDictionary::intern(std::string_view text, Arena* arena) {
+    auto it = ids.find(text);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    std::string_view stored = arena ? arena->copy(text) : text;
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back(stored);
+    ids.emplace(stored, id);
+    return id;
+}
+
+std::optional<uint32_t> StringDictionary::find(std::string_view text) const {
+    auto it = ids.find(text);
+    if (it == ids.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void StringDictionary::clear() {
+    strings.clear();
+    ids.clear();
+}
+
+LogBatch::LogBatch(bool copy_text) : copy_text(copy_text) {
+}
+
+void LogBatch::add(const LogEntryView& entry) {
+    Arena* text_arena = copy_text ? &arena : nullptr;
+    columns.timestamps.push_back(copy_text ? arena.copy(entry.timestamp) : entry.timestamp);
+    columns.times.push_back(parseTimeOfDay(entry.timestamp));
+    columns.levels.push_back(static_cast<uint8_t>(entry.level));
+    columns.messages.push_back(copy_text ? arena.copy(entry.message) : entry.message);
+    columns.source_files.push_back(source_files.intern(entry.source_file, text_arena));
+    columns.source_functions.push_back(source_functions.intern(entry.source_function, text_arena));
+    columns.source_lines.push_back(entry.source_line);
+}
+
+void LogBatch::addLine(std::string_view line, LogLevel level, int32_t time) {
+    columns.lines.push_back(copy_text ? arena.copy(line) : line);
+    columns.levels.push_back(static_cast<uint8_t>(level));
+    columns.times.push_back(time);
+}
+
+void LogBatch::add(const LogEntryView& entry, int32_t time, uint16_t origin) {
+    columns.timestamps.push_back(entry.timestamp);
+    columns.times.push_back(time);
+    columns.levels.push_back(static_cast<uint8_t>(entry.level));
+    columns.messages.push_back(entry.message);
+    columns.source_files.push_back(source_files.intern(entry.source_file));
+    columns.source_functions.push_back(source_functions.intern(entry.source_function));
+    columns.source_lines.push_back(entry.source_line);
+    columns.origins.push_back(origin);
+}
+
+void LogBatch::setOrigin(uint16_t origin) {
+    columns.origins.assign(columns.size(), origin);
+}
+
+bool LogStore::map(const std::string& file_path, bool lazy_rows, LogSchemaId schema) {
+    clear();
+    lazy = lazy_rows;
+    line_schema = schema;
+    return file.open(file_path);
+}
+
+bool LogStore::mapMerged(const std::vector<std::string>& file_paths) {
+    clear();
+    if (file_paths.size() > UINT16_MAX + 1u) {
+        return false;
+    }
+    for (const std::string& path : file_paths) {
+        MappedFile input;
+        if (!input.open(path)) {
+            clear();
+            return false;
+        }
+        origin_files.push_back(std::move(input));
+        origin_names.push_back(path);
+    }
+    return true;
+}
+
+uint16_t LogStore::addOrigin(const std::string& name) {
+    if (origin_names.size() > UINT16_MAX) {
+        return UINT16_MAX;
+    }
+    origin_names.push_back(name);
+    return static_cast<uint16_t>(origin_names.size() - 1);
+}
+
+void LogStore::clear() {
+    // Columns and dictionaries reference the mapping and arenas, so they go first
+    published.store(0, std::memory_order_release);
+    columns.timestamps.clear();
+    columns.times.clear();
+    columns.levels.clear();
+    columns.messages.clear();
+    columns.source_files.clear();
+    columns.source_functions.clear();
+    columns.source_lines.clear();
+    columns.lines.clear();
+    columns.origins.clear();
+    level_index.clear();
+    time_index.clear();
+    source_files.clear();
+    source_functions.clear();
+    arenas.clear();
+    arenas.shrink_to_fit();
+    file.close();
+    origin_files.clear();
+    origin_names.clear();
+    lazy = false;
+    line_schema = LogSchemaId::STANDARD;
+    clear_count++;
+}
+
+template <typename T>
+static void appendColumn(SegmentedColumn<T>& column, const std::vector<T>& values) {
+    for (const T& value : values) {
+        column.push_back(value);
+    }
+}
+
+// Append batch-local dictionary ids translated to store ids
+static void appendRemapped(SegmentedColumn<uint32_t>& column, const std::vector<uint32_t>& local_ids,
+                           const StringDictionary& local, StringDictionary& global) {
+    // One lookup per distinct string rather than per entry
+    std::vector<uint32_t> remap(local.size());
+    for (uint32_t id = 0; id < local.size(); ++id) {
+        remap[id] = global.intern(local[id]);
+    }
+    for (uint32_t id : local_ids) {
+        column.push_back(remap[id]);
+    }
+}
+
+void LogStore::append(LogBatch&& batch) {
+    StageTimer timer(MetricStage::APPEND);
+    timer.addItems(batch.size());
+    const LogColumns& values = batch.columns;
+    appendColumn(columns.timestamps, values.timestamps);
+    appendColumn(columns.times, values.times);
+    appendColumn(columns.levels, values.levels);
+    appendColumn(columns.messages, values.messages);
+    appendRemapped(columns.source_files, values.source_files, batch.source_files, source_files);
+    appendRemapped(columns.source_functions, values.source_functions, batch.source_functions, source_functions);
+    appendColumn(columns.source_lines, values.source_lines);
+    appendColumn(columns.lines, values.lines);
+    appendColumn(columns.origins, values.origins);
+    level_index.extend(columns.size());
+    time_index.extend(columns.size());
+    
+    if (batch.arena.capacity() > 0) {
+        arenas.push_back(std::move(batch.arena));
+    }
+    
+    // Make the new rows visible to readers only once every column has them
+    published.store(columns.size(), std::memory_order_release);
+}
+
+LogEntryView LogStore::operator[](size_t index) const {
+    if (lazy) {
+        LogEntryView entry;
+        parseLogLine(columns.lines[index], entry, line_schema);
+        return entry;
+    }
+    return LogEntryView{
+        columns.timestamps[index],
+        static_cast<LogLevel>(columns.levels[index]),
+        columns.messages[index],
+        source_files[columns.source_files[index]],
+        source_functions[columns.source_functions[index]],
+        columns.source_lines[index],
+    };
+}
+
+std::string_view LogStore::message(size_t index) const {
+    return lazy ? logMessageField(columns.lines[index], line_schema) : columns.messages[index];
+}
+
+size_t LogStore::arenaBytes() const {
+    size_t total = 0;
+    for (const auto& arena : arenas) {
+        total += arena.capacity();
+    }
+    return total;
+}
@@ -0,0 +1,204 @@
+#ifndef LOG_STORE_HPP
+#define LOG_STORE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Arena.hpp"
+#include "LevelIndex.hpp"
+#include "LineParser.hpp"
+#include "TimeIndex.hpp"
+#include "LogEntry.hpp"
+#include "MappedFile.hpp"
+#include "SegmentedColumn.hpp"
+
+// Dictionary encoding: each distinct string gets a dense id. Lookups by id
+// are safe while another thread interns; intern() and find() are not.
+class StringDictionary {
+public:
+    // Id of text, adding it if new. New strings are copied into arena when
+    // one is given, otherwise the view is kept as-is.
+    uint32_t intern(std::string_view text, Arena* arena = nullptr);
+    std::optional<uint32_t> find(std::string_view text) const;
+    std::string_view operator[](uint32_t id) const { return strings[id]; }
+    size_t size() const { return strings.size(); }
+    void clear();
+
+private:
+    SegmentedColumn<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> ids;
+};
+
+// Entry fields stored column by column, so scans over one field (levels,
+// times, sources) only touch that field's array
+template <template <typename> class Column>
+struct BasicLogColumns {
+    Column<std::string_view> timestamps;   // Raw timestamp text
+    Column<int32_t> times;                 // Milliseconds since midnight, -1 if unparsed
+    Column<uint8_t> levels;                // LogLevel values
+    Column<std::string_view> messages;
+    Column<uint32_t> source_files;         // Source file dictionary ids
+    Column<uint32_t> source_functions;     // Source function dictionary ids
+    Column<int32_t> source_lines;
+    Column<std::string_view> lines;        // Whole lines, lazy stores only
+    Column<uint16_t> origins;              // Input file indices, merged stores only
+
+    size_t size() const { return levels.size(); }
+};
+
+template <typename T>
+using VectorColumn = std::vector<T>;
+
+// Columns of a batch under construction
+using LogColumns = BasicLogColumns<VectorColumn>;
+
+// Entries parsed from one range of input, encoded against the batch's own
+// source dictionaries. With copy_text, text is copied into the batch's arena
+// so the batch doesn't depend on the buffer it was parsed from.
+class LogBatch {
+public:
+    explicit LogBatch(bool copy_text = false);
+
+    void add(const LogEntryView& entry);
+    
+    // Record only a line, its level and its time, for lazy stores
+    void addLine(std::string_view line, LogLevel level, int32_t time);
+    
+    // Record an entry of a merged store, whose time the merge has parsed.
+    // Text is always kept as views into the mapped inputs.
+    void add(const LogEntryView& entry, int32_t time, uint16_t origin);
+    
+    // Give every row so far origin, for stores fed by several network streams
+    void setOrigin(uint16_t origin);
+    
+    size_t size() const { return columns.size(); }
+
+private:
+    friend class LogStore;
+
+    bool copy_text;
+    Arena arena;
+    StringDictionary source_files;
+    StringDictionary source_functions;
+    LogColumns columns;
+};
+
+// Columnar entry storage for one loaded log. Text columns are views into
+// either the memory-mapped file (zero-copy loads) or arenas adopted from
+// batches (copied loads), so they stay valid until the store is cleared or
+// remapped.
+//
+// One writer appends (under the caller's lock) while readers use any index
+// below size() without locking: columns never move, and size() is
+// published only after every column of the new rows is written. map() and
+// clear() must not run concurrently with readers.
+//
+// A lazy store keeps just each row's line, level and time, which is enough
+// for counts, level filters and time seeks; the other fields are decoded
+// from the line whenever a row is read. Its column accessors other than
+// levels() and times() are empty, so readers go through operator[] and
+// message().
+//
+// A merged store maps several files and interleaves their entries by time;
+// origin() tells which file each row came from. A store fed by network
+// streams has an origin per sending host instead, added with addOrigin()
+// as hosts connect, and keeps rows in the order they arrived.
+class LogStore {
+public:
+    // Map file_path, whose lines are laid out as schema, and drop any
+    // previous entries. Returns false on failure.
+    bool map(const std::string& file_path, bool lazy = false, LogSchemaId schema = LogSchemaId::STANDARD);
+    
+    bool isLazy() const { return lazy; }
+    
+    // Layout lazy rows are decoded with, and mapped stores are cached for
+    LogSchemaId schema() const { return line_schema; }
+    
+    // Map every file for a merged store and drop any previous entries.
+    // Returns false if one can't be mapped or there are too many.
+    bool mapMerged(const std::vector<std::string>& file_paths);
+    
+    // Whether rows have an origin(): merged files or network streams
+    bool isMerged() const { return origin_names.size() > 0; }
+    
+    // Inputs of a merged store, by origin(); only files have text
+    size_t originCount() const { return origin_names.size(); }
+    const std::string& originName(size_t origin) const { return origin_names[origin]; }
+    std::string_view originText(size_t origin) const { return origin_files[origin].view(); }
+    
+    // Input file a row of a merged store came from, 0 for other stores
+    uint16_t origin(size_t index) const { return isMerged() ? columns.origins[index] : 0; }
+    
+    // Add an input named name, such as a stream's host, for the rows of
+    // later batches tagged with the returned origin. Called by the writer;
+    // readers may look names up meanwhile. Past UINT16_MAX inputs the last
+    // one is shared.
+    uint16_t addOrigin(const std::string& name);
+
+    // Drop all entries, free every arena and unmap the file in one go
+    void clear();
+
+    // Append a batch, re-encoding its sources against the store's
+    // dictionaries and taking ownership of its arena
+    void append(LogBatch&& batch);
+
+    // Changes whenever the store is cleared or remapped, so cached indices
+    // over its entries can tell they are stale
+    uint64_t generation() const { return clear_count; }
+
+    std::string_view text() const { return file.view(); }
+
+    // Entries readers may access; a stable prefix while the writer appends
+    size_t size() const { return published.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+
+    // Assemble one row
+    LogEntryView operator[](size_t index) const;
+
+    LogLevel level(size_t index) const { return static_cast<LogLevel>(columns.levels[index]); }
+    std::string_view message(size_t index) const;
+    int32_t time(size_t index) const { return columns.times[index]; }
+
+    // Whole columns, for scans with SegmentedColumn::forEachSpan()
+    const SegmentedColumn<std::string_view>& timestamps() const { return columns.timestamps; }
+    const SegmentedColumn<uint8_t>& levels() const { return columns.levels; }
+    const SegmentedColumn<int32_t>& times() const { return columns.times; }
+    const SegmentedColumn<std::string_view>& messages() const { return columns.messages; }
+    const SegmentedColumn<uint32_t>& sourceFileIds() const { return columns.source_files; }
+    const SegmentedColumn<uint32_t>& sourceFunctionIds() const { return columns.source_functions; }
+    const SegmentedColumn<int32_t>& sourceLines() const { return columns.source_lines; }
+
+    const StringDictionary& sourceFiles() const { return source_files; }
+    const StringDictionary& sourceFunctions() const { return source_functions; }
+    
+    // Per-level bitmaps, kept current with every append
+    const LevelIndex& levelIndex() const { return level_index; }
+    const TimeIndex& timeIndex() const { return time_index; }
+
+    // Bytes of entry text held in arenas
+    size_t arenaBytes() const;
+
+private:
+    // Restores columns straight from an on-disk cache
+    friend size_t loadIndexCache(const std::string& file_path, LogStore& store, size_t& line_count);
+    
+    MappedFile file;
+    std::vector<MappedFile> origin_files;
+    SegmentedColumn<std::string> origin_names;
+    std::vector<Arena> arenas;
+    StringDictionary source_files;
+    StringDictionary source_functions;
+    BasicLogColumns<SegmentedColumn> columns;
+    LevelIndex level_index{columns.levels};
+    TimeIndex time_index{columns.times};
+    std::atomic<size_t> published{0};
+    uint64_t clear_count = 0;
+    bool lazy = false;
+    LogSchemaId line_schema = LogSchemaId::STANDARD;
+};
+
+#endif // LOG_STORE_HPP
@@ -0,0 +1,175 @@
+#include "MappedFile.hpp"
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#include <filesystem>
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#undef ERROR
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        swap(other);
+    }
+    return *this;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept {
+    std::swap(mapped_data, other.mapped_data);
+    std::swap(mapped_size, other.mapped_size);
+    std::swap(is_open, other.is_open);
+#ifdef _WIN32
+    std::swap(file_handle, other.file_handle);
+    std::swap(mapping_handle, other.mapping_handle);
+#else
+    std::swap(file_descriptor, other.file_descriptor);
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& file_path) {
+    close();
+
+    std::filesystem::path path(file_path);
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    // Only regular files can be mapped; pipes and devices must be streamed
+    LARGE_INTEGER file_size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle = file;
+    is_open = true;
+
+    // Zero-length files can't be mapped; treat them as an empty view
+    if (file_size.QuadPart == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    mapping_handle = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        close();
+        return false;
+    }
+
+    mapped_data = static_cast<const char*>(view);
+    mapped_size = static_cast<size_t>(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::release(size_t offset, size_t length) {
+    // Unlocking pages that aren't locked trims them from the working set
+    if (mapped_data && offset < mapped_size && length > 0) {
+        VirtualUnlock(const_cast<char*>(mapped_data + offset), std::min(length, mapped_size - offset));
+    }
+}
+
+void MappedFile::close() {
+    if (mapped_data) {
+        UnmapViewOfFile(mapped_data);
+    }
+    if (mapping_handle) {
+        CloseHandle(mapping_handle);
+    }
+    if (file_handle) {
+        CloseHandle(file_handle);
+    }
+    mapped_data = nullptr;
+    mapped_size = 0;
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+    is_open = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& file_path) {
+    close();
+
+    int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Only regular files can be mapped; pipes and devices must be streamed
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    file_descriptor = fd;
+    is_open = true;
+
+    // Zero-length files can't be mapped; treat them as an empty view
+    if (file_stat.st_size == 0) {
+        return true;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    mapped_data = static_cast<const char*>(view);
+    mapped_size = static_cast<size_t>(file_stat.st_size);
+    return true;
+}
+
+void MappedFile::release(size_t offset, size_t length) {
+    // Only whole pages inside the range, so neighbouring data stays resident
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t end = std::min(offset + length, mapped_size);
+    size_t first = (offset + page_size - 1) / page_size * page_size;
+    size_t last = end == mapped_size ? end : end / page_size * page_size;
+    if (mapped_data && first < last) {
+        madvise(const_cast<char*>(mapped_data + first), last - first, MADV_DONTNEED);
+    }
+}
+
+void MappedFile::close() {
+    if (mapped_data) {
+        munmap(const_cast<char*>(mapped_data), mapped_size);
+    }
+    if (file_descriptor >= 0) {
+        ::close(file_descriptor);
+    }
+    mapped_data = nullptr;
+    mapped_size = 0;
+    file_descriptor = -1;
+    is_open = false;
+}
+
+#endif
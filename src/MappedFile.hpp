@@ -0,0 +1,52 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file (mmap / CreateFileMapping).
+// The mapping stays valid until close() or destruction, so views handed
+// out by view() must not outlive this object.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Map file_path read-only. Returns false if the file can't be opened or mapped.
+    bool open(const std::string& file_path);
+
+    // Unmap and release all handles
+    void close();
+
+    // Drop the pages of [offset, offset + length) from this process's
+    // memory, for one-pass readers that don't need the whole file
+    // resident. Reading them again pages them back in from the file.
+    void release(size_t offset, size_t length);
+
+    bool isOpen() const { return is_open; }
+    const char* data() const { return mapped_data; }
+    size_t size() const { return mapped_size; }
+    std::string_view view() const { return std::string_view(mapped_data, mapped_size); }
+
+private:
+    const char* mapped_data = nullptr;
+    size_t mapped_size = 0;
+    bool is_open = false;
+
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#else
+    int file_descriptor = -1;
+#endif
+
+    void swap(MappedFile& other) noexcept;
+};
+
+#endif // MAPPED_FILE_HPP
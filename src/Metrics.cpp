@@ -0,0 +1,160 @@
+#include "Metrics.hpp"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#endif
+
+static const size_t STAGE_COUNT = static_cast<size_t>(MetricStage::COUNT);
+
+// Beyond this a trace stops growing; the events so far are still written
+static const size_t MAX_TRACE_EVENTS = 4 * 1024 * 1024;
+
+struct AtomicStageStats {
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+    std::atomic<uint64_t> last_ns{0};
+    std::atomic<uint64_t> items{0};
+};
+
+struct TraceEvent {
+    MetricStage stage;
+    uint32_t thread;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint64_t items;
+};
+
+static AtomicStageStats stage_stats[STAGE_COUNT];
+static std::atomic<bool> tracing{false};
+static std::mutex trace_mutex;
+static std::vector<TraceEvent> trace_events;
+static std::atomic<uint32_t> next_thread_id{1};
+
+const char* metricStageName(MetricStage stage) {
+    switch (stage) {
+        case MetricStage::READ:    return "read";
+        case MetricStage::SPLIT:   return "split";
+        case MetricStage::PARSE:   return "parse";
+        case MetricStage::APPEND:  return "append";
+        case MetricStage::FILTER:  return "filter";
+        case MetricStage::SEARCH:  return "search";
+        case MetricStage::INDEX:   return "index";
+        case MetricStage::SUMMARY: return "summary";
+        case MetricStage::RENDER:  return "render";
+        default:                   return "unknown";
+    }
+}
+
+uint64_t metricsNow() {
+    static const auto EPOCH = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - EPOCH).count());
+}
+
+void recordStage(MetricStage stage, uint64_t start_ns, uint64_t duration_ns, uint64_t items) {
+    AtomicStageStats& stats = stage_stats[static_cast<size_t>(stage)];
+    stats.samples.fetch_add(1, std::memory_order_relaxed);
+    stats.total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+    stats.last_ns.store(duration_ns, std::memory_order_relaxed);
+    stats.items.fetch_add(items, std::memory_order_relaxed);
+    uint64_t max = stats.max_ns.load(std::memory_order_relaxed);
+    while (duration_ns > max && !stats.max_ns.compare_exchange_weak(max, duration_ns, std::memory_order_relaxed)) {
+    }
+
+    if (tracing.load(std::memory_order_relaxed)) {
+        thread_local uint32_t thread = next_thread_id++;
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        if (trace_events.size() < MAX_TRACE_EVENTS) {
+            trace_events.push_back(TraceEvent{stage, thread, start_ns, duration_ns, items});
+        }
+    }
+}
+
+MetricsSnapshot metricsSnapshot() {
+    MetricsSnapshot snapshot;
+    for (size_t s = 0; s < STAGE_COUNT; ++s) {
+        const AtomicStageStats& stats = stage_stats[s];
+        snapshot.stages[s].samples = stats.samples.load(std::memory_order_relaxed);
+        snapshot.stages[s].total_ns = stats.total_ns.load(std::memory_order_relaxed);
+        snapshot.stages[s].max_ns = stats.max_ns.load(std::memory_order_relaxed);
+        snapshot.stages[s].last_ns = stats.last_ns.load(std::memory_order_relaxed);
+        snapshot.stages[s].items = stats.items.load(std::memory_order_relaxed);
+    }
+    snapshot.resident_bytes = residentBytes();
+    snapshot.taken = std::chrono::steady_clock::now();
+    return snapshot;
+}
+
+size_t residentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return info.resident_size;
+    }
+    return 0;
+#else
+    // Second field of statm is resident pages
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0;
+    size_t resident_pages = 0;
+    if (statm >> total_pages >> resident_pages) {
+        return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+    return 0;
+#endif
+}
+
+void startTrace() {
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_events.clear();
+    tracing = true;
+}
+
+bool isTracing() {
+    return tracing;
+}
+
+bool writeChromeTrace(const std::string& file_path) {
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        tracing = false;
+        events.swap(trace_events);
+    }
+
+    std::FILE* out = std::fopen(file_path.c_str(), "wb");
+    if (!out) {
+        return false;
+    }
+    // Complete ("X") events with microsecond timestamps
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", out);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& event = events[i];
+        std::fprintf(out, "%s{\"name\":\"%s\",\"cat\":\"logreader\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                     "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"items\":%llu}}\n",
+                     i ? "," : "", metricStageName(event.stage), event.thread, event.start_ns / 1000.0,
+                     event.duration_ns / 1000.0, static_cast<unsigned long long>(event.items));
+    }
+    std::fputs("]}\n", out);
+    return std::fclose(out) == 0;
+}
@@ -0,0 +1,80 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Process-wide timing of the load, filter and render pipeline. Stages are
+// timed a whole range, batch, chunk or frame at a time, never per line,
+// and each sample is a handful of relaxed atomic updates, so timers stay
+// on in release builds. While a trace is recording, samples are also kept
+// as Chrome trace events (chrome://tracing, Perfetto).
+enum class MetricStage {
+    READ,       // Waiting for input: decompressed chunks, stream blocks, followed appends
+    SPLIT,      // Cutting a buffer into newline-aligned ranges
+    PARSE,      // Parsing a range or batch; items are entries
+    APPEND,     // Adding a batch to a store; items are rows
+    FILTER,     // FilterIndex::update()
+    SEARCH,     // Scanning a chunk of rows for a search term; items are rows
+    INDEX,      // Indexing a chunk of rows into a trigram index; items are rows
+    SUMMARY,    // Counting a chunk of rows for the summary panel; items are rows
+    RENDER,     // Building one frame of the log view
+    COUNT
+};
+
+const char* metricStageName(MetricStage stage);
+
+struct StageStats {
+    uint64_t samples = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t last_ns = 0;
+    uint64_t items = 0;
+};
+
+struct MetricsSnapshot {
+    StageStats stages[static_cast<size_t>(MetricStage::COUNT)];
+    size_t resident_bytes = 0;   // 0 where the platform doesn't report it
+    std::chrono::steady_clock::time_point taken;
+
+    const StageStats& operator[](MetricStage stage) const { return stages[static_cast<size_t>(stage)]; }
+};
+
+// Nanoseconds on the steady clock since the first call
+uint64_t metricsNow();
+
+// Record one sample of stage that began at start_ns (from metricsNow())
+void recordStage(MetricStage stage, uint64_t start_ns, uint64_t duration_ns, uint64_t items = 0);
+
+MetricsSnapshot metricsSnapshot();
+
+// Resident memory of this process
+size_t residentBytes();
+
+// Keep samples as trace events (at most a few million) until
+// writeChromeTrace(), which writes them as Chrome trace JSON and stops.
+// Returns false if the file can't be written.
+void startTrace();
+bool isTracing();
+bool writeChromeTrace(const std::string& file_path);
+
+// Times its own lifetime as one sample of a stage
+class StageTimer {
+public:
+    explicit StageTimer(MetricStage stage) : stage(stage), start(metricsNow()) {}
+    ~StageTimer() { recordStage(stage, start, metricsNow() - start, items); }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    void addItems(uint64_t count) { items += count; }
+
+private:
+    MetricStage stage;
+    uint64_t start;
+    uint64_t items = 0;
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,534 @@
+#include "Query.hpp"
+#include "LevelIndex.hpp"
+#include "LineParser.hpp"
+#include "LogStore.hpp"
+#include "TimeIndex.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+
+using Node = Query::Node;
+
+static std::atomic<uint64_t> next_id{1};
+
+struct Lexeme {
+    enum Type { LEFT, RIGHT, AND, OR, NOT, TERM };
+    Type type;
+    std::string name;    // TERM: field, level or time; empty for a bare word
+    std::string op;      // TERM with a name: ":", "~", "=", "!=", "<", "<=", ">" or ">="
+    std::string value;
+};
+
+static bool isNamedTerm(const std::string& name) {
+    static const char* const NAMES[] = {"level", "time", "msg", "message", "source", "file", "func", "function"};
+    return std::find_if(std::begin(NAMES), std::end(NAMES), [&](const char* n) { return name == n; }) != std::end(NAMES);
+}
+
+class QueryParser {
+public:
+    explicit QueryParser(std::string_view text) : text(text) {}
+
+    bool has_field_term = false;   // Saw a level, time or field term
+
+    bool tokenize(std::string& error) {
+        size_t i = 0;
+        while (true) {
+            while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) i++;
+            if (i >= text.size()) return true;
+
+            char c = text[i];
+            if (c == '(' || c == ')') {
+                lexemes.push_back({c == '(' ? Lexeme::LEFT : Lexeme::RIGHT, "", "", ""});
+                i++;
+                continue;
+            }
+            if (c == '"') {
+                Lexeme term{Lexeme::TERM, "", "", ""};
+                if (!readQuoted(i, term.value, error)) return false;
+                lexemes.push_back(std::move(term));
+                continue;
+            }
+
+            // name<op>value, or a bare word
+            size_t name_end = i;
+            while (name_end < text.size() && std::isalpha(static_cast<unsigned char>(text[name_end]))) name_end++;
+            std::string name(text.substr(i, name_end - i));
+            std::transform(name.begin(), name.end(), name.begin(),
+                           [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+            std::string op = operatorAt(name_end);
+            if (isNamedTerm(name) && !op.empty()) {
+                i = name_end + op.size();
+                Lexeme term{Lexeme::TERM, name, op, ""};
+                if (i < text.size() && text[i] == '"') {
+                    if (!readQuoted(i, term.value, error)) return false;
+                } else {
+                    term.value = std::string(readWord(i));
+                }
+                if (term.value.empty()) {
+                    error = "missing value after " + name + op;
+                    return false;
+                }
+                lexemes.push_back(std::move(term));
+                has_field_term = true;
+                continue;
+            }
+
+            std::string_view word = readWord(i);
+            if (word == "AND" || word == "OR" || word == "NOT") {
+                lexemes.push_back({word == "AND" ? Lexeme::AND : word == "OR" ? Lexeme::OR : Lexeme::NOT, "", "", ""});
+            } else {
+                lexemes.push_back({Lexeme::TERM, "", "", std::string(word)});
+            }
+        }
+    }
+
+    bool parse(Node& root, std::string& error) {
+        if (lexemes.empty()) {
+            root = Node{};
+            return true;
+        }
+        if (!parseOr(root, error)) return false;
+        if (next < lexemes.size()) {
+            error = "unexpected )";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    std::string_view text;
+    std::vector<Lexeme> lexemes;
+    size_t next = 0;
+
+    std::string operatorAt(size_t i) const {
+        static const char* const OPERATORS[] = {">=", "<=", "!=", ":", "~", "=", ">", "<"};
+        for (const char* op : OPERATORS) {
+            if (text.substr(i, std::char_traits<char>::length(op)) == op) return op;
+        }
+        return "";
+    }
+
+    // Up to the next space or ")"
+    std::string_view readWord(size_t& i) const {
+        size_t begin = i;
+        while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) && text[i] != ')') i++;
+        return text.substr(begin, i - begin);
+    }
+
+    // "..." with \" and \\ unescaped; other backslashes are kept for regexes
+    bool readQuoted(size_t& i, std::string& value, std::string& error) const {
+        for (i++; i < text.size(); ++i) {
+            if (text[i] == '"') {
+                i++;
+                return true;
+            }
+            if (text[i] == '\\' && i + 1 < text.size() && (text[i + 1] == '"' || text[i + 1] == '\\')) {
+                i++;
+            }
+            value += text[i];
+        }
+        error = "unterminated quote";
+        return false;
+    }
+
+    bool at(Lexeme::Type type) const { return next < lexemes.size() && lexemes[next].type == type; }
+
+    bool parseOr(Node& node, std::string& error) {
+        if (!parseAnd(node, error)) return false;
+        while (at(Lexeme::OR)) {
+            next++;
+            Node right;
+            if (!parseAnd(right, error)) return false;
+            if (node.kind != Node::OR) {
+                Node either;
+                either.kind = Node::OR;
+                either.children.push_back(std::move(node));
+                node = std::move(either);
+            }
+            node.children.push_back(std::move(right));
+        }
+        return true;
+    }
+
+    bool parseAnd(Node& node, std::string& error) {
+        node = Node{};
+        node.kind = Node::AND;
+        do {
+            if (at(Lexeme::AND)) next++;
+            Node term;
+            if (!parseUnary(term, error)) return false;
+            node.children.push_back(std::move(term));
+        } while (next < lexemes.size() && !at(Lexeme::OR) && !at(Lexeme::RIGHT));
+        if (node.children.size() == 1) {
+            Node only = std::move(node.children[0]);
+            node = std::move(only);
+        }
+        return true;
+    }
+
+    bool parseUnary(Node& node, std::string& error) {
+        if (next >= lexemes.size()) {
+            error = "missing term at the end";
+            return false;
+        }
+        const Lexeme& lexeme = lexemes[next++];
+        switch (lexeme.type) {
+            case Lexeme::NOT: {
+                Node child;
+                if (!parseUnary(child, error)) return false;
+                node = Node{};
+                node.kind = Node::NOT;
+                node.children.push_back(std::move(child));
+                return true;
+            }
+            case Lexeme::LEFT:
+                if (!parseOr(node, error)) return false;
+                if (!at(Lexeme::RIGHT)) {
+                    error = "missing )";
+                    return false;
+                }
+                next++;
+                return true;
+            case Lexeme::TERM:
+                return buildTerm(lexeme, node, error);
+            default:
+                error = lexeme.type == Lexeme::RIGHT ? "unexpected )" : "missing term before AND or OR";
+                return false;
+        }
+    }
+
+    static int levelRank(LogLevel level) {
+        switch (level) {
+            case LogLevel::DEBUG: return 0;
+            case LogLevel::INFO:  return 1;
+            case LogLevel::WARN:  return 2;
+            case LogLevel::ERROR: return 3;
+            default:              return -1;
+        }
+    }
+
+    static bool buildLevel(const Lexeme& lexeme, Node& node, std::string& error) {
+        std::string name = lexeme.value;
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char ch) { return static_cast<char>(std::toupper(ch)); });
+        LogLevel level = parseLogLevel(name);
+        if (name != logLevelName(level)) {
+            error = "unknown level " + lexeme.value;
+            return false;
+        }
+        node.kind = Node::LEVEL;
+        const std::string& op = lexeme.op;
+        unsigned bit = 1u << static_cast<unsigned>(level);
+        if (op == "=" || op == ":") {
+            node.levels = bit;
+            return true;
+        }
+        if (op == "!=") {
+            node.levels = LevelIndex::ALL_LEVELS & ~bit;
+            return true;
+        }
+        int rank = levelRank(level);
+        if (rank < 0 || op == "~") {
+            error = "level" + op + lexeme.value + " can't be compared";
+            return false;
+        }
+        for (unsigned l = 0; l < LevelIndex::LEVEL_COUNT; ++l) {
+            int r = levelRank(static_cast<LogLevel>(l));
+            if (r >= 0 && ((op == "<" && r < rank) || (op == "<=" && r <= rank) ||
+                           (op == ">" && r > rank) || (op == ">=" && r >= rank))) {
+                node.levels |= 1u << l;
+            }
+        }
+        return true;
+    }
+
+    static bool buildTime(const Lexeme& lexeme, Node& node, std::string& error) {
+        int64_t clock = TimeIndex::parseClock(lexeme.value);
+        if (clock < 0) {
+            error = "invalid time " + lexeme.value;
+            return false;
+        }
+        node.kind = Node::TIME;
+        const std::string& op = lexeme.op;
+        if (op == ">=") {
+            node.time_from = clock;
+        } else if (op == ">") {
+            node.time_from = clock + 1;
+        } else if (op == "<") {
+            node.time_to = clock;
+        } else if (op == "<=") {
+            node.time_to = clock + 1;
+        } else {
+            error = "time needs <, <=, > or >=";
+            return false;
+        }
+        return true;
+    }
+
+    static bool buildTerm(const Lexeme& lexeme, Node& node, std::string& error) {
+        node = Node{};
+        if (lexeme.name == "level") return buildLevel(lexeme, node, error);
+        if (lexeme.name == "time") return buildTime(lexeme, node, error);
+
+        const std::string& name = lexeme.name;
+        node.field = name == "source" || name == "file" ? Query::Field::SOURCE
+                   : name == "func" || name == "function" ? Query::Field::FUNCTION
+                   : Query::Field::MESSAGE;
+        node.text = lexeme.value;
+        const std::string& op = lexeme.op;
+        if (op.empty() || op == ":") {
+            node.kind = Node::CONTAINS;
+        } else if (op == "=" || op == "!=") {
+            node.kind = Node::EQUALS;
+            if (op == "!=") {
+                Node equals = std::move(node);
+                node = Node{};
+                node.kind = Node::NOT;
+                node.children.push_back(std::move(equals));
+            }
+        } else if (op == "~") {
+            node.kind = Node::REGEX;
+            std::string regex_error;
+            if (!node.regex.compile(lexeme.value, regex_error)) {
+                error = name + "~" + lexeme.value + ": " + regex_error;
+                return false;
+            }
+        } else {
+            error = name + " needs :, =, != or ~";
+            return false;
+        }
+        return true;
+    }
+};
+
+// Rough cost of testing a node on one row, to order AND terms
+static int cost(const Node& node) {
+    switch (node.kind) {
+        case Node::LEVEL:    return 0;
+        case Node::EQUALS:   return 1;
+        case Node::CONTAINS: return node.field == Query::Field::MESSAGE ? 2 : 1;
+        case Node::REGEX:    return node.field == Query::Field::MESSAGE ? 3 : 1;
+        case Node::TIME:     return 0;
+        default: {
+            int most = 0;
+            for (const Node& child : node.children) most = std::max(most, cost(child));
+            return most;
+        }
+    }
+}
+
+static bool containsTime(const Node& node) {
+    return node.kind == Node::TIME ||
+           std::any_of(node.children.begin(), node.children.end(), containsTime);
+}
+
+// Merge nested ANDs and put every AND's cheapest terms first
+static void optimize(Node& node) {
+    for (Node& child : node.children) optimize(child);
+    if (node.kind == Node::AND) {
+        std::vector<Node> flat;
+        for (Node& child : node.children) {
+            if (child.kind == Node::AND) {
+                for (Node& grandchild : child.children) flat.push_back(std::move(grandchild));
+            } else {
+                flat.push_back(std::move(child));
+            }
+        }
+        node.children = std::move(flat);
+    }
+    if (node.kind == Node::AND || node.kind == Node::OR) {
+        std::stable_sort(node.children.begin(), node.children.end(),
+                         [](const Node& a, const Node& b) { return cost(a) < cost(b); });
+    }
+}
+
+// Which ids of the store's source dictionaries pass each source and
+// function term of one query, by Node::slot, extended as the dictionaries
+// grow
+struct SourceMatches {
+    uint64_t query = 0;
+    const LogStore* store = nullptr;
+    uint64_t generation = 0;
+    std::vector<std::vector<bool>> slots;
+};
+
+static const size_t CACHED_QUERIES = 4;
+
+// The calling thread's id results for a query on a store
+static SourceMatches& threadSourceMatches(uint64_t query, const LogStore& store, size_t slot_count) {
+    thread_local SourceMatches cache[CACHED_QUERIES];
+    thread_local size_t replace_next = 0;
+    for (SourceMatches& matches : cache) {
+        if (matches.query == query && matches.store == &store && matches.generation == store.generation()) {
+            return matches;
+        }
+    }
+    SourceMatches& matches = cache[replace_next];
+    replace_next = (replace_next + 1) % CACHED_QUERIES;
+    matches.query = query;
+    matches.store = &store;
+    matches.generation = store.generation();
+    matches.slots.assign(slot_count, {});
+    return matches;
+}
+
+static bool testText(const Node& node, std::string_view text) {
+    switch (node.kind) {
+        case Node::CONTAINS: return text.find(node.text) != std::string_view::npos;
+        case Node::EQUALS:   return text == node.text;
+        default:             return node.regex.search(text);
+    }
+}
+
+// A row's fields. Source terms on a store row are answered from the id
+// columns; rows of lazy stores are decoded when a term needs more than
+// their level and message.
+class RowFields {
+public:
+    explicit RowFields(const LogEntryView& entry) : entry(&entry) {}
+    RowFields(const LogStore& store, size_t row, SourceMatches* matches)
+        : store(&store), row(row), matches(matches) {}
+
+    LogLevel level() const { return entry ? entry->level : store->level(row); }
+
+    // A CONTAINS, EQUALS or REGEX term
+    bool test(const Node& node) {
+        if (node.field == Query::Field::MESSAGE) {
+            return testText(node, entry ? entry->message : store->message(row));
+        }
+        if (matches) {
+            bool file = node.field == Query::Field::SOURCE;
+            const StringDictionary& names = file ? store->sourceFiles() : store->sourceFunctions();
+            uint32_t id = (file ? store->sourceFileIds() : store->sourceFunctionIds())[row];
+            std::vector<bool>& passing = matches->slots[node.slot];
+            for (size_t i = passing.size(), count = names.size(); i < count; ++i) {
+                passing.push_back(testText(node, names[static_cast<uint32_t>(i)]));
+            }
+            return passing[id];
+        }
+        if (!entry) {
+            decoded = (*store)[row];
+            entry = &decoded;
+        }
+        return testText(node, node.field == Query::Field::SOURCE ? entry->source_file : entry->source_function);
+    }
+
+private:
+    const LogEntryView* entry = nullptr;
+    const LogStore* store = nullptr;
+    size_t row = 0;
+    SourceMatches* matches = nullptr;
+    LogEntryView decoded;
+};
+
+static bool evaluate(const Node& node, RowFields& fields) {
+    switch (node.kind) {
+        case Node::AND:
+            for (const Node& child : node.children) {
+                if (!evaluate(child, fields)) return false;
+            }
+            return true;
+        case Node::OR:
+            for (const Node& child : node.children) {
+                if (evaluate(child, fields)) return true;
+            }
+            return false;
+        case Node::NOT:
+            return !evaluate(node.children[0], fields);
+        case Node::LEVEL:
+            return (node.levels >> static_cast<unsigned>(fields.level())) & 1u;
+        case Node::CONTAINS:
+        case Node::EQUALS:
+        case Node::REGEX:
+            return fields.test(node);
+        default:
+            return true;
+    }
+}
+
+// Number the source and function terms for their id results
+static void assignSlots(Node& node, size_t& slot_count) {
+    if ((node.kind == Node::CONTAINS || node.kind == Node::EQUALS || node.kind == Node::REGEX) &&
+        node.field != Query::Field::MESSAGE) {
+        node.slot = static_cast<int>(slot_count++);
+    }
+    for (Node& child : node.children) assignSlots(child, slot_count);
+}
+
+// Text after an explicit QUERY_PREFIX, if there is one
+static std::string_view withoutPrefix(std::string_view text, bool& prefixed) {
+    size_t first = text.find_first_not_of(" \t");
+    prefixed = first != std::string_view::npos && text[first] == Query::QUERY_PREFIX;
+    return prefixed ? text.substr(first + 1) : text;
+}
+
+std::shared_ptr<const Query> Query::compile(std::string_view text, std::string& error) {
+    bool prefixed;
+    QueryParser parser(withoutPrefix(text, prefixed));
+    Node root;
+    if (!parser.tokenize(error) || !parser.parse(root, error)) {
+        return nullptr;
+    }
+    optimize(root);
+
+    auto query = std::make_shared<Query>();
+    query->source = std::string(text);
+    query->level_mask = LevelIndex::ALL_LEVELS;
+    query->residual.kind = Node::AND;
+
+    // Levels and times of the top-level AND are answered from the indices
+    std::vector<Node> terms;
+    if (root.kind == Node::AND) {
+        terms = std::move(root.children);
+    } else {
+        terms.push_back(std::move(root));
+    }
+    for (Node& term : terms) {
+        if (term.kind == Node::LEVEL) {
+            query->level_mask &= term.levels;
+        } else if (term.kind == Node::TIME) {
+            if (term.time_from >= 0) query->time_from = std::max(query->time_from, term.time_from);
+            if (term.time_to >= 0) {
+                query->time_to = query->time_to < 0 ? term.time_to : std::min(query->time_to, term.time_to);
+            }
+        } else if (containsTime(term)) {
+            error = "time terms can only be combined with AND";
+            return nullptr;
+        } else {
+            query->residual.children.push_back(std::move(term));
+        }
+    }
+    assignSlots(query->residual, query->slot_count);
+    query->id = next_id++;
+    return query;
+}
+
+bool Query::isQuery(std::string_view text) {
+    bool prefixed;
+    QueryParser parser(withoutPrefix(text, prefixed));
+    if (prefixed) {
+        return true;
+    }
+    // AND, OR, NOT and parentheses are common in log text, so only field
+    // terms make a query; text that doesn't even tokenize (an open quote)
+    // is still plain text
+    std::string error;
+    return parser.tokenize(error) && parser.has_field_term;
+}
+
+bool Query::matches(const LogEntryView& entry) const {
+    if (!((level_mask >> static_cast<unsigned>(entry.level)) & 1u)) {
+        return false;
+    }
+    RowFields fields(entry);
+    return evaluate(residual, fields);
+}
+
+bool Query::matches(const LogStore& store, size_t row) const {
+    if (!((level_mask >> static_cast<unsigned>(store.level(row))) & 1u)) {
+        return false;
+    }
+    SourceMatches* matches = slot_count > 0 && !store.isLazy() ? &threadSourceMatches(id, store, slot_count) : nullptr;
+    RowFields fields(store, row, matches);
+    return evaluate(residual, fields);
+}
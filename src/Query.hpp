@@ -0,0 +1,92 @@
+#ifndef QUERY_HPP
+#define QUERY_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "LogEntry.hpp"
+#include "Regex.hpp"
+
+class LogStore;
+
+// Structured search, typed into the search box or given to --query:
+//
+//   level>=WARN AND source:Vulkan.cpp AND msg~"timeout [0-9]+ms"
+//
+// Terms:
+//   level=L  (also != < <= > >=)   DEBUG < INFO < WARN < ERROR; FOOTER and
+//                                  HEADER only compare with = and !=
+//   time>=T  (also > < <=)         T as in the Time box, HH:MM:SS[.fff][+day]
+//   msg:TEXT, source:TEXT, func:TEXT    The message, source file or function
+//                                       contains TEXT; = for the whole field
+//   msg~RE, source~RE, func~RE          The field matches the regex RE
+//   TEXT                                The message contains TEXT
+// Values with spaces or parentheses go in double quotes (\" and \\ escape).
+// Terms combine with AND (or just spaces), OR, NOT and parentheses, AND
+// binding tighter than OR. Search text is a query when it has a level,
+// time or field term, or starts with "?" (for queries of bare words).
+//
+// compile() turns the text into a plan once: the level and time terms of
+// the top-level AND become a level mask and a time range, answered from
+// the store's LevelIndex and TimeIndex before any row is read, and the
+// rest is a predicate tree tested on the surviving rows with the cheapest
+// tests first and message regexes last. Source and function terms are
+// tested once per distinct string of the store's dictionaries, on first
+// use, and rows then just look up their dictionary ids. Time terms can't
+// be inside OR or NOT. A compiled query is immutable and can be shared
+// between threads; the per-store id results are kept per thread.
+class Query {
+public:
+    enum class Field { MESSAGE, SOURCE, FUNCTION };
+
+    // Leading character making any search text a query
+    static constexpr char QUERY_PREFIX = '?';
+
+    struct Node {
+        enum Kind { AND, OR, NOT, LEVEL, CONTAINS, EQUALS, REGEX, TIME };
+        Kind kind = AND;
+        Field field = Field::MESSAGE;
+        unsigned levels = 0;          // LEVEL: bit per LogLevel that passes
+        std::string text;             // CONTAINS and EQUALS
+        Regex regex;                  // REGEX
+        int64_t time_from = -1;       // TIME: clocks of the range passing, [from, to)
+        int64_t time_to = -1;
+        std::vector<Node> children;   // AND, OR and NOT
+        int slot = -1;                // Source and function terms: index of their id results
+    };
+
+    // nullptr with a message if text isn't a valid query
+    static std::shared_ptr<const Query> compile(std::string_view text, std::string& error);
+
+    // Whether text has a level, time or field term, or QUERY_PREFIX; text
+    // with just words, AND, OR, NOT or parentheses, as in "404 NOT FOUND"
+    // or "initVulkan()", is searched for as plain text
+    static bool isQuery(std::string_view text);
+
+    const std::string& text() const { return source; }
+
+    // Levels and TimeIndex clock range ([from, to), -1 for open) allowed
+    // by the top-level AND
+    unsigned levelMask() const { return level_mask; }
+    int64_t timeFrom() const { return time_from; }
+    int64_t timeTo() const { return time_to; }
+
+    // The level mask and every other term except the time range. The
+    // store overload reads source ids rather than decoding the row, except
+    // in lazy stores.
+    bool matches(const LogEntryView& entry) const;
+    bool matches(const LogStore& store, size_t row) const;
+
+private:
+    std::string source;
+    unsigned level_mask = 0;
+    int64_t time_from = -1;
+    int64_t time_to = -1;
+    Node residual;                    // AND of the remaining terms; empty passes everything
+    size_t slot_count = 0;            // Source and function terms in residual
+    uint64_t id = 0;                  // Identifies the query in per-thread id results
+};
+
+#endif // QUERY_HPP
@@ -0,0 +1,607 @@
+#include "Regex.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <map>
+#include <memory>
+
+using NfaState = Regex::NfaState;
+using CharSet = std::bitset<256>;
+
+// Limits that keep compiled patterns and their DFAs small
+static const size_t MAX_NFA_STATES = 10000;
+static const int MAX_REPEAT = 1000;
+static const size_t MAX_DFA_STATES = 2000;      // A thread's DFA starts over beyond this
+static const size_t CACHED_PATTERNS = 8;        // DFAs each thread keeps
+
+static std::atomic<uint64_t> next_id{1};
+
+// Parsed pattern
+struct RegexNode {
+    enum Kind { SET, CONCAT, ALTERNATE, REPEAT, BEGIN, END };
+    Kind kind;
+    CharSet set;
+    int min = 0;
+    int max = -1;       // REPEAT upper bound, -1 for none
+    std::vector<RegexNode> children;
+};
+
+class RegexParser {
+public:
+    RegexParser(std::string_view pattern, bool ignore_case) : pattern(pattern), ignore_case(ignore_case) {}
+
+    bool parse(RegexNode& root, std::string& error) {
+        if (!parseAlternate(root)) {
+            error = message;
+            return false;
+        }
+        if (position < pattern.size()) {
+            error = "unmatched ) in regex";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    std::string_view pattern;
+    bool ignore_case;
+    size_t position = 0;
+    std::string message;
+
+    bool fail(const std::string& text) {
+        message = text;
+        return false;
+    }
+
+    bool atEnd() const { return position >= pattern.size(); }
+    char peek() const { return pattern[position]; }
+
+    CharSet single(unsigned char c) const {
+        CharSet set;
+        set.set(c);
+        if (ignore_case && std::isalpha(c)) {
+            set.set(static_cast<unsigned char>(std::tolower(c)));
+            set.set(static_cast<unsigned char>(std::toupper(c)));
+        }
+        return set;
+    }
+
+    static CharSet classOf(int (*test)(int)) {
+        CharSet set;
+        for (int c = 0; c < 256; ++c) {
+            if (test(c)) set.set(c);
+        }
+        return set;
+    }
+
+    static int isWord(int c) { return std::isalnum(c) || c == '_'; }
+
+    // \d-style classes; false if c isn't one
+    static bool escapeClass(char c, CharSet& set) {
+        switch (c) {
+            case 'd': set = classOf([](int c) { return std::isdigit(c); }); return true;
+            case 'D': set = ~classOf([](int c) { return std::isdigit(c); }); return true;
+            case 'w': set = classOf(isWord); return true;
+            case 'W': set = ~classOf(isWord); return true;
+            case 's': set = classOf([](int c) { return std::isspace(c); }); return true;
+            case 'S': set = ~classOf([](int c) { return std::isspace(c); }); return true;
+            default:  return false;
+        }
+    }
+
+    static unsigned char escapedChar(char c) {
+        switch (c) {
+            case 't': return '\t';
+            case 'n': return '\n';
+            case 'r': return '\r';
+            default:  return static_cast<unsigned char>(c);
+        }
+    }
+
+    bool parseAlternate(RegexNode& node) {
+        RegexNode first;
+        if (!parseConcat(first)) return false;
+        if (atEnd() || peek() != '|') {
+            node = std::move(first);
+            return true;
+        }
+        node = RegexNode{RegexNode::ALTERNATE, {}, 0, -1, {}};
+        node.children.push_back(std::move(first));
+        while (!atEnd() && peek() == '|') {
+            position++;
+            RegexNode next;
+            if (!parseConcat(next)) return false;
+            node.children.push_back(std::move(next));
+        }
+        return true;
+    }
+
+    bool parseConcat(RegexNode& node) {
+        node = RegexNode{RegexNode::CONCAT, {}, 0, -1, {}};
+        while (!atEnd() && peek() != '|' && peek() != ')') {
+            RegexNode piece;
+            if (!parseRepeat(piece)) return false;
+            node.children.push_back(std::move(piece));
+        }
+        return true;
+    }
+
+    bool parseNumber(int& value) {
+        size_t begin = position;
+        value = 0;
+        while (!atEnd() && std::isdigit(static_cast<unsigned char>(peek())) && value <= MAX_REPEAT) {
+            value = value * 10 + (pattern[position++] - '0');
+        }
+        // Too large to matter exactly; the caller rejects it
+        while (!atEnd() && std::isdigit(static_cast<unsigned char>(peek()))) {
+            position++;
+        }
+        return position > begin;
+    }
+
+    bool parseRepeat(RegexNode& node) {
+        RegexNode atom;
+        if (!parseAtom(atom)) return false;
+        while (!atEnd()) {
+            int min, max;
+            char c = peek();
+            if (c == '*') {
+                min = 0, max = -1;
+                position++;
+            } else if (c == '+') {
+                min = 1, max = -1;
+                position++;
+            } else if (c == '?') {
+                min = 0, max = 1;
+                position++;
+            } else if (c == '{') {
+                position++;
+                if (!parseNumber(min)) return fail("expected a number after { in regex");
+                max = min;
+                if (!atEnd() && peek() == ',') {
+                    position++;
+                    if (!parseNumber(max)) max = -1;
+                }
+                if (atEnd() || peek() != '}') return fail("expected } in regex");
+                position++;
+                if (min > MAX_REPEAT || max > MAX_REPEAT || (max >= 0 && max < min)) {
+                    return fail("bad repeat count in regex");
+                }
+            } else {
+                break;
+            }
+            if (atom.kind == RegexNode::BEGIN || atom.kind == RegexNode::END) {
+                return fail("nothing to repeat in regex");
+            }
+            RegexNode repeat{RegexNode::REPEAT, {}, min, max, {}};
+            repeat.children.push_back(std::move(atom));
+            atom = std::move(repeat);
+        }
+        node = std::move(atom);
+        return true;
+    }
+
+    bool parseClass(CharSet& set) {
+        bool negate = !atEnd() && peek() == '^';
+        if (negate) position++;
+        bool first = true;
+        while (!atEnd() && (peek() != ']' || first)) {
+            first = false;
+            unsigned char low = static_cast<unsigned char>(pattern[position++]);
+            if (low == '\\') {
+                if (atEnd()) break;
+                CharSet escaped;
+                if (escapeClass(peek(), escaped)) {
+                    position++;
+                    set |= escaped;
+                    continue;
+                }
+                low = escapedChar(pattern[position++]);
+            }
+            unsigned char high = low;
+            if (position + 1 < pattern.size() && peek() == '-' && pattern[position + 1] != ']') {
+                position++;
+                high = static_cast<unsigned char>(pattern[position++]);
+                if (high == '\\' && !atEnd()) {
+                    high = escapedChar(pattern[position++]);
+                }
+                if (high < low) return fail("bad range in regex class");
+            }
+            for (unsigned c = low; c <= high; ++c) {
+                set |= single(static_cast<unsigned char>(c));
+            }
+        }
+        if (atEnd()) return fail("unterminated [ in regex");
+        position++;
+        if (negate) set.flip();
+        return true;
+    }
+
+    bool parseAtom(RegexNode& node) {
+        char c = pattern[position++];
+        node = RegexNode{RegexNode::SET, {}, 0, -1, {}};
+        switch (c) {
+            case '(':
+                // Groups never capture, so (?:...) is the same as (...)
+                if (pattern.substr(position, 2) == "?:") {
+                    position += 2;
+                }
+                if (!parseAlternate(node)) return false;
+                if (atEnd() || peek() != ')') return fail("unmatched ( in regex");
+                position++;
+                return true;
+            case '[':
+                return parseClass(node.set);
+            case '.':
+                node.set.set();
+                node.set.reset('\n');
+                return true;
+            case '^':
+                node.kind = RegexNode::BEGIN;
+                return true;
+            case '$':
+                node.kind = RegexNode::END;
+                return true;
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+                return fail("nothing to repeat in regex");
+            case '\\':
+                if (atEnd()) return fail("trailing \\ in regex");
+                if (!escapeClass(peek(), node.set)) {
+                    node.set = single(escapedChar(peek()));
+                }
+                position++;
+                return true;
+            default:
+                node.set = single(static_cast<unsigned char>(c));
+                return true;
+        }
+    }
+};
+
+// Thompson construction: a fragment is a start state and the outputs
+// still to be connected to whatever follows
+struct Fragment {
+    int start;
+    std::vector<std::pair<int, bool>> outs;   // State, and whether it's out2
+};
+
+class NfaBuilder {
+public:
+    explicit NfaBuilder(std::vector<NfaState>& states) : states(states) {}
+
+    bool build(const RegexNode& node, Fragment& fragment) {
+        switch (node.kind) {
+            case RegexNode::SET: {
+                int s = add(NfaState::SET);
+                if (s < 0) return false;
+                states[s].set = node.set;
+                fragment = {s, {{s, false}}};
+                return true;
+            }
+            case RegexNode::BEGIN:
+            case RegexNode::END: {
+                int s = add(node.kind == RegexNode::BEGIN ? NfaState::BEGIN : NfaState::END);
+                if (s < 0) return false;
+                fragment = {s, {{s, false}}};
+                return true;
+            }
+            case RegexNode::CONCAT: {
+                if (node.children.empty()) return empty(fragment);
+                if (!build(node.children[0], fragment)) return false;
+                for (size_t i = 1; i < node.children.size(); ++i) {
+                    Fragment next;
+                    if (!build(node.children[i], next)) return false;
+                    patch(fragment, next.start);
+                    fragment.outs = std::move(next.outs);
+                }
+                return true;
+            }
+            case RegexNode::ALTERNATE: {
+                if (!build(node.children[0], fragment)) return false;
+                for (size_t i = 1; i < node.children.size(); ++i) {
+                    Fragment next;
+                    if (!build(node.children[i], next)) return false;
+                    int s = add(NfaState::SPLIT);
+                    if (s < 0) return false;
+                    states[s].out = fragment.start;
+                    states[s].out2 = next.start;
+                    fragment.start = s;
+                    fragment.outs.insert(fragment.outs.end(), next.outs.begin(), next.outs.end());
+                }
+                return true;
+            }
+            case RegexNode::REPEAT:
+                return repeat(node, fragment);
+        }
+        return false;
+    }
+
+private:
+    std::vector<NfaState>& states;
+
+    int add(NfaState::Type type) {
+        if (states.size() >= MAX_NFA_STATES) return -1;
+        NfaState state;
+        state.type = type;
+        states.push_back(state);
+        return static_cast<int>(states.size() - 1);
+    }
+
+    void patch(const Fragment& fragment, int target) {
+        for (const auto& [s, second] : fragment.outs) {
+            (second ? states[s].out2 : states[s].out) = target;
+        }
+    }
+
+    bool empty(Fragment& fragment) {
+        int s = add(NfaState::EMPTY);
+        if (s < 0) return false;
+        fragment = {s, {{s, false}}};
+        return true;
+    }
+
+    // x{min,max} as min copies of x followed by max - min optional ones,
+    // or by x* without an upper bound
+    bool repeat(const RegexNode& node, Fragment& fragment) {
+        const RegexNode& child = node.children[0];
+        if (!empty(fragment)) return false;
+        for (int i = 0; i < node.min; ++i) {
+            Fragment next;
+            if (!build(child, next)) return false;
+            patch(fragment, next.start);
+            fragment.outs = std::move(next.outs);
+        }
+        int optional = node.max < 0 ? 1 : node.max - node.min;
+        for (int i = 0; i < optional; ++i) {
+            Fragment next;
+            if (!build(child, next)) return false;
+            int s = add(NfaState::SPLIT);
+            if (s < 0) return false;
+            states[s].out = next.start;
+            patch(fragment, s);
+            if (node.max < 0) {
+                patch(next, s);
+                fragment.outs = {{s, true}};
+            } else {
+                fragment.outs = std::move(next.outs);
+                fragment.outs.push_back({s, true});
+            }
+        }
+        return true;
+    }
+};
+
+// Longest run of single characters every match must contain, from the
+// top-level sequence of the pattern
+static std::string requiredLiteral(const RegexNode& root) {
+    std::string best, run;
+    auto end_run = [&] {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+    const RegexNode* node = &root;
+    while (node->kind == RegexNode::CONCAT && node->children.size() == 1) {
+        node = &node->children[0];
+    }
+    if (node->kind == RegexNode::SET && node->set.count() == 1) {
+        for (int c = 0; c < 256; ++c) {
+            if (node->set.test(c)) return std::string(1, static_cast<char>(c));
+        }
+    }
+    if (node->kind != RegexNode::CONCAT) return best;
+    for (const RegexNode& child : node->children) {
+        if (child.kind == RegexNode::SET && child.set.count() == 1) {
+            for (int c = 0; c < 256; ++c) {
+                if (child.set.test(c)) run += static_cast<char>(c);
+            }
+        } else if (child.kind != RegexNode::BEGIN && child.kind != RegexNode::END) {
+            end_run();
+        }
+    }
+    end_run();
+    return best;
+}
+
+// Whether the whole pattern is a plain sequence of single characters
+static bool isLiteral(const RegexNode& root) {
+    if (root.kind == RegexNode::SET) return root.set.count() == 1;
+    if (root.kind != RegexNode::CONCAT) return false;
+    return std::all_of(root.children.begin(), root.children.end(), [](const RegexNode& child) {
+        return child.kind == RegexNode::SET && child.set.count() == 1;
+    });
+}
+
+bool Regex::compile(std::string_view pattern, std::string& error) {
+    source = std::string(pattern);
+    states.clear();
+    literal.clear();
+    literal_only = false;
+    start = -1;
+
+    bool ignore_case = pattern.substr(0, 4) == "(?i)";
+    if (ignore_case) {
+        pattern.remove_prefix(4);
+    }
+    RegexNode root;
+    RegexParser parser(pattern, ignore_case);
+    if (!parser.parse(root, error)) {
+        return false;
+    }
+
+    Fragment fragment;
+    NfaBuilder builder(states);
+    if (!builder.build(root, fragment) || states.size() >= MAX_NFA_STATES) {
+        error = "regex is too large";
+        states.clear();
+        return false;
+    }
+    NfaState match;
+    match.type = NfaState::MATCH;
+    states.push_back(match);
+    for (const auto& [s, second] : fragment.outs) {
+        (second ? states[s].out2 : states[s].out) = static_cast<int>(states.size() - 1);
+    }
+    start = fragment.start;
+    id = next_id++;
+
+    if (!ignore_case) {
+        literal = requiredLiteral(root);
+        literal_only = isLiteral(root);
+    }
+    return true;
+}
+
+// One thread's DFA for one NFA. Each DFA state is a sorted set of NFA
+// states, interned the first time a transition reaches it.
+struct Dfa {
+    uint64_t id = 0;
+    std::map<std::vector<int>, int> ids;
+    std::vector<std::vector<int>> sets;
+    std::vector<int> next;               // 256 transitions per state, -1 until computed
+    std::vector<uint8_t> accepting;      // Contains MATCH
+    std::vector<int8_t> accepting_at_end;   // Contains MATCH once "$" holds, -1 until computed
+    int start = -1;                      // State at the beginning of the text
+};
+
+// Add s and every state reachable from it without reading a character.
+// END states are kept in the set and only followed when at_end.
+static void closure(const std::vector<NfaState>& states, int s, bool at_begin, bool at_end,
+                    std::vector<uint8_t>& seen, std::vector<int>& set) {
+    std::vector<int> stack{s};
+    while (!stack.empty()) {
+        int state = stack.back();
+        stack.pop_back();
+        if (state < 0 || seen[state]) continue;
+        seen[state] = 1;
+        const NfaState& nfa = states[state];
+        switch (nfa.type) {
+            case NfaState::SPLIT:
+                stack.push_back(nfa.out2);
+                stack.push_back(nfa.out);
+                break;
+            case NfaState::EMPTY:
+                stack.push_back(nfa.out);
+                break;
+            case NfaState::BEGIN:
+                if (at_begin) stack.push_back(nfa.out);
+                break;
+            case NfaState::END:
+                set.push_back(state);
+                if (at_end) stack.push_back(nfa.out);
+                break;
+            default:
+                set.push_back(state);
+                break;
+        }
+    }
+}
+
+static int intern(Dfa& dfa, const std::vector<NfaState>& states, std::vector<int> set) {
+    std::sort(set.begin(), set.end());
+    auto found = dfa.ids.find(set);
+    if (found != dfa.ids.end()) return found->second;
+
+    int id = static_cast<int>(dfa.sets.size());
+    bool accepting = std::any_of(set.begin(), set.end(), [&](int s) { return states[s].type == NfaState::MATCH; });
+    dfa.ids.emplace(set, id);
+    dfa.sets.push_back(std::move(set));
+    dfa.next.insert(dfa.next.end(), 256, -1);
+    dfa.accepting.push_back(accepting);
+    dfa.accepting_at_end.push_back(-1);
+    return id;
+}
+
+static void resetDfa(Dfa& dfa) {
+    dfa.ids.clear();
+    dfa.sets.clear();
+    dfa.next.clear();
+    dfa.accepting.clear();
+    dfa.accepting_at_end.clear();
+    dfa.start = -1;
+}
+
+// The calling thread's DFA for an NFA, built as searches need it
+static Dfa& threadDfa(uint64_t id) {
+    thread_local std::vector<std::unique_ptr<Dfa>> cache;
+    thread_local size_t replace_next = 0;
+    for (auto& dfa : cache) {
+        if (dfa->id == id) return *dfa;
+    }
+    if (cache.size() < CACHED_PATTERNS) {
+        cache.push_back(std::make_unique<Dfa>());
+        cache.back()->id = id;
+        return *cache.back();
+    }
+    Dfa& dfa = *cache[replace_next];
+    replace_next = (replace_next + 1) % CACHED_PATTERNS;
+    resetDfa(dfa);
+    dfa.id = id;
+    return dfa;
+}
+
+bool Regex::search(std::string_view text) const {
+    if (start < 0) {
+        return false;
+    }
+    if (!literal.empty() && text.find(literal) == std::string_view::npos) {
+        return false;
+    }
+    if (literal_only) {
+        return true;
+    }
+
+    Dfa& dfa = threadDfa(id);
+    thread_local std::vector<uint8_t> seen;
+    auto closure_of = [&](const std::vector<int>& seeds, bool at_begin, bool at_end) {
+        seen.assign(states.size(), 0);
+        std::vector<int> set;
+        for (int s : seeds) {
+            closure(states, s, at_begin, at_end, seen, set);
+        }
+        return set;
+    };
+
+    if (dfa.start < 0) {
+        dfa.start = intern(dfa, states, closure_of({start}, true, false));
+    }
+    int current = dfa.start;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (dfa.accepting[current]) return true;
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        int next = dfa.next[static_cast<size_t>(current) * 256 + c];
+        if (next < 0) {
+            // Follow c from every state, and start a new match here too
+            std::vector<int> seeds{start};
+            for (int s : dfa.sets[current]) {
+                if (states[s].type == NfaState::SET && states[s].set.test(c)) {
+                    seeds.push_back(states[s].out);
+                }
+            }
+            std::vector<int> set = closure_of(seeds, false, false);
+            bool full = dfa.sets.size() >= MAX_DFA_STATES;
+            if (full) {
+                // Start over; current is gone, so its transition isn't kept
+                resetDfa(dfa);
+                dfa.start = intern(dfa, states, closure_of({start}, true, false));
+            }
+            next = intern(dfa, states, std::move(set));
+            if (!full) {
+                dfa.next[static_cast<size_t>(current) * 256 + c] = next;
+            }
+        }
+        current = next;
+    }
+    if (dfa.accepting[current]) return true;
+
+    // "$" only holds here
+    if (dfa.accepting_at_end[current] < 0) {
+        std::vector<int> set = closure_of(dfa.sets[current], false, true);
+        dfa.accepting_at_end[current] = std::any_of(set.begin(), set.end(), [&](int s) {
+            return states[s].type == NfaState::MATCH;
+        });
+    }
+    return dfa.accepting_at_end[current] > 0;
+}
@@ -0,0 +1,45 @@
+#ifndef REGEX_HPP
+#define REGEX_HPP
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Regular expressions for queries, matched by a DFA built lazily from a
+// Thompson NFA, so matching is linear in the text with no backtracking
+// (unlike std::regex). Supports literals, ".", "[...]" classes with ranges
+// and negation, \d \w \s \D \W \S and escaped punctuation, "^" and "$",
+// groups, "|", the * + ? {n} {n,} {n,m} quantifiers and a leading "(?i)"
+// for case-insensitive matching. A pattern matches if it matches anywhere
+// in the text. DFA states are kept per thread, so search() is const and
+// can be called from several threads at once.
+class Regex {
+public:
+    // Replace the pattern. Returns false with a message for bad patterns.
+    bool compile(std::string_view pattern, std::string& error);
+
+    // Whether the pattern matches somewhere in text
+    bool search(std::string_view text) const;
+
+    const std::string& pattern() const { return source; }
+
+    struct NfaState {
+        enum Type : uint8_t { SET, SPLIT, EMPTY, BEGIN, END, MATCH };
+        Type type;
+        int out = -1;
+        int out2 = -1;          // SPLIT only
+        std::bitset<256> set;   // SET only
+    };
+
+private:
+    std::string source;
+    std::vector<NfaState> states;
+    int start = -1;
+    uint64_t id = 0;            // Identifies the NFA in per-thread DFA caches
+    std::string literal;        // Text every match contains, checked first
+    bool literal_only = false;  // The pattern is just literal
+};
+
+#endif // REGEX_HPP
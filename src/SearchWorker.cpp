@@ -0,0 +1,124 @@
+#include "SearchWorker.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+SearchWorker::~SearchWorker() {
+    cancel();
+}
+
+void SearchWorker::start(const LogStore& store, unsigned level_mask, const std::string& term,
+                         std::shared_ptr<const Query> query, size_t begin, size_t end, ProgressCallback on_progress) {
+    cancel();
+    matches.clear();
+
+    // Set before the thread starts so an immediate cancel() isn't lost
+    stop_requested = false;
+    searched = begin;
+    running = true;
+    search_thread = std::thread(&SearchWorker::run, this, std::cref(store), level_mask, term, std::move(query),
+                                begin, end, std::move(on_progress));
+}
+
+void SearchWorker::cancel() {
+    stop_requested = true;
+    wait();
+}
+
+void SearchWorker::clear() {
+    cancel();
+    matches.clear();
+}
+
+void SearchWorker::wait() {
+    if (search_thread.joinable()) {
+        search_thread.join();
+    }
+}
+
+void SearchWorker::run(const LogStore& store, unsigned level_mask, std::string term,
+                       std::shared_ptr<const Query> query, size_t begin, size_t end, ProgressCallback on_progress) {
+    unsigned threads = thread_count;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Chunks are whole bitmap words so each is scanned straight from the level index
+    const size_t CHUNK_ROWS = 16 * 1024;
+    size_t first_chunk = begin / CHUNK_ROWS;
+    size_t chunk_count = end > begin ? (end + CHUNK_ROWS - 1) / CHUNK_ROWS - first_chunk : 0;
+
+    std::vector<std::optional<std::vector<size_t>>> results(chunk_count);
+    std::mutex results_mutex;
+    std::condition_variable chunk_done;
+    std::atomic<size_t> next_chunk{0};
+
+    auto worker = [&]() {
+        const LevelIndex& levels = store.levelIndex();
+        for (size_t c = next_chunk++; c < chunk_count; c = next_chunk++) {
+            std::vector<size_t> found;
+
+            // Cancelled chunks are still marked done so the stitcher never blocks
+            if (!stop_requested) {
+                size_t chunk_begin = std::max(begin, (first_chunk + c) * CHUNK_ROWS);
+                size_t chunk_end = std::min(end, (first_chunk + c + 1) * CHUNK_ROWS);
+                StageTimer timer(MetricStage::SEARCH);
+                timer.addItems(chunk_end - chunk_begin);
+                levels.forEachRow(level_mask, chunk_begin, chunk_end, [&](size_t row) {
+                    if ((term.empty() || store.message(row).find(term) != std::string_view::npos) &&
+                        (!query || query->matches(store, row))) {
+                        found.push_back(row);
+                    }
+                });
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(results_mutex);
+                results[c] = std::move(found);
+            }
+            chunk_done.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    size_t worker_count = std::min<size_t>(threads, chunk_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(worker);
+    }
+
+    // Publish matches in row order, waking the UI at most every 30 ms
+    const auto PROGRESS_INTERVAL = std::chrono::milliseconds(30);
+    auto last_progress = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < chunk_count; ++c) {
+        std::optional<std::vector<size_t>> found;
+        {
+            std::unique_lock<std::mutex> lock(results_mutex);
+            chunk_done.wait(lock, [&] { return results[c].has_value(); });
+            found.swap(results[c]);
+        }
+        if (stop_requested) continue;
+
+        for (size_t row : *found) {
+            matches.push_back(row);
+        }
+        searched.store(std::min(end, (first_chunk + c + 1) * CHUNK_ROWS), std::memory_order_release);
+        auto now = std::chrono::steady_clock::now();
+        if (!found->empty() && now - last_progress >= PROGRESS_INTERVAL && on_progress) {
+            last_progress = now;
+            on_progress();
+        }
+    }
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    running = false;
+    if (!stop_requested && on_progress) {
+        on_progress();
+    }
+}
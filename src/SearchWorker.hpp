@@ -0,0 +1,64 @@
+#ifndef SEARCH_WORKER_HPP
+#define SEARCH_WORKER_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include "LogStore.hpp"
+#include "Query.hpp"
+#include "SegmentedColumn.hpp"
+
+// Background message search over a range of a store's rows. Chunks of rows
+// are scanned in parallel and their matches are appended in row order as
+// each chunk completes, so the first screenful is readable long before the
+// scan finishes. Matches can be read from the UI thread while the search
+// runs; start() and cancel() must come from that same thread.
+class SearchWorker {
+public:
+    using ProgressCallback = std::function<void()>;
+
+    ~SearchWorker();
+
+    // Cancel any running search and start scanning rows [begin, end) of store
+    // for messages containing term (unless it's empty) and matching query
+    // (unless it's null) among the levels in level_mask. on_progress is
+    // called from the worker as matches are added and once at the end.
+    void start(const LogStore& store, unsigned level_mask, const std::string& term,
+               std::shared_ptr<const Query> query, size_t begin, size_t end, ProgressCallback on_progress);
+
+    // Stop the running search and wait for its threads; matches so far stay
+    void cancel();
+
+    // Cancel and drop every match
+    void clear();
+
+    // Wait for the running search to finish
+    void wait();
+
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Matches published so far, in row order
+    size_t size() const { return matches.size(); }
+    size_t operator[](size_t position) const { return matches[position]; }
+
+    // End of the rows whose matches are all published: from begin up to end
+    size_t searchedTo() const { return searched.load(std::memory_order_acquire); }
+
+    // Scan threads (0 = all cores)
+    void setThreadCount(unsigned count) { thread_count = count; }
+
+private:
+    SegmentedColumn<size_t> matches;
+    std::thread search_thread;
+    std::atomic<bool> stop_requested{false};
+    std::atomic<bool> running{false};
+    std::atomic<size_t> searched{0};
+    unsigned thread_count = 0;
+
+    void run(const LogStore& store, unsigned level_mask, std::string term, std::shared_ptr<const Query> query,
+             size_t begin, size_t end, ProgressCallback on_progress);
+};
+
+#endif // SEARCH_WORKER_HPP
@@ -0,0 +1,112 @@
+#ifndef SEGMENTED_COLUMN_HPP
+#define SEGMENTED_COLUMN_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Append-only column for one writer and any number of readers. Elements
+// live in segments that double in size and never move, so readers can
+// index any position below size() without a lock while the writer keeps
+// appending. The element count is published with release semantics after
+// the element is written.
+//
+// clear() and moves must not race with readers.
+template <typename T>
+class SegmentedColumn {
+public:
+    SegmentedColumn() = default;
+    ~SegmentedColumn() { clear(); }
+
+    SegmentedColumn(const SegmentedColumn&) = delete;
+    SegmentedColumn& operator=(const SegmentedColumn&) = delete;
+
+    SegmentedColumn(SegmentedColumn&& other) noexcept { take(other); }
+    SegmentedColumn& operator=(SegmentedColumn&& other) noexcept {
+        if (this != &other) {
+            clear();
+            take(other);
+        }
+        return *this;
+    }
+
+    void push_back(const T& value) {
+        size_t index = count.load(std::memory_order_relaxed);
+        size_t segment = segmentOf(index);
+        T* data = segments[segment].load(std::memory_order_relaxed);
+        if (!data) {
+            data = new T[segmentSize(segment)];
+            segments[segment].store(data, std::memory_order_release);
+        }
+        data[index - segmentStart(segment)] = value;
+        count.store(index + 1, std::memory_order_release);
+    }
+
+    const T& operator[](size_t index) const {
+        size_t segment = segmentOf(index);
+        return segments[segment].load(std::memory_order_acquire)[index - segmentStart(segment)];
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    // Call fn(data, first_index, length) for each contiguous run of
+    // elements in [begin, end), for tight loops over one segment at a time
+    template <typename Fn>
+    void forEachSpan(size_t begin, size_t end, Fn&& fn) const {
+        while (begin < end) {
+            size_t segment = segmentOf(begin);
+            size_t segment_end = segmentStart(segment) + segmentSize(segment);
+            size_t span_end = end < segment_end ? end : segment_end;
+            const T* data = segments[segment].load(std::memory_order_acquire);
+            fn(data + (begin - segmentStart(segment)), begin, span_end - begin);
+            begin = span_end;
+        }
+    }
+
+    void clear() {
+        for (auto& segment : segments) {
+            delete[] segment.load(std::memory_order_relaxed);
+            segment.store(nullptr, std::memory_order_relaxed);
+        }
+        count.store(0, std::memory_order_release);
+    }
+
+private:
+    // Segment s holds BASE << s elements starting at BASE * (2^s - 1)
+    static constexpr size_t BASE_SHIFT = 10;
+    static constexpr size_t BASE = size_t(1) << BASE_SHIFT;
+    static constexpr size_t MAX_SEGMENTS = 48;
+
+    std::atomic<T*> segments[MAX_SEGMENTS] = {};
+    std::atomic<size_t> count{0};
+
+    static size_t floorLog2(uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return index;
+#else
+        return 63 - static_cast<size_t>(__builtin_clzll(value));
+#endif
+    }
+
+    static size_t segmentOf(size_t index) { return floorLog2((index >> BASE_SHIFT) + 1); }
+    static size_t segmentStart(size_t segment) { return BASE * ((size_t(1) << segment) - 1); }
+    static size_t segmentSize(size_t segment) { return BASE << segment; }
+
+    void take(SegmentedColumn& other) {
+        for (size_t i = 0; i < MAX_SEGMENTS; ++i) {
+            segments[i].store(other.segments[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.segments[i].store(nullptr, std::memory_order_relaxed);
+        }
+        count.store(other.count.load(std::memory_order_relaxed), std::memory_order_release);
+        other.count.store(0, std::memory_order_relaxed);
+    }
+};
+
+#endif // SEGMENTED_COLUMN_HPP
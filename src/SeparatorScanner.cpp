@@ -0,0 +1,191 @@
+#include "SeparatorScanner.hpp"
+#include "LineParser.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SEPARATOR_SCANNER_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define SEPARATOR_SCANNER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang need per-function target attributes to emit AVX2 without
+// building the whole program for it; MSVC accepts the intrinsics as-is
+#if defined(SEPARATOR_SCANNER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define TARGET_AVX2
+#define TARGET_SSE2
+#endif
+
+static inline unsigned countTrailingZeros(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+#if defined(_M_X64) || defined(_M_ARM64)
+    _BitScanForward64(&index, value);
+#else
+    if (static_cast<uint32_t>(value)) {
+        _BitScanForward(&index, static_cast<uint32_t>(value));
+    } else {
+        _BitScanForward(&index, static_cast<uint32_t>(value >> 32));
+        index += 32;
+    }
+#endif
+    return index;
+#else
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#endif
+}
+
+// Append base + bit index for every set bit of mask
+static inline size_t emitPositions(uint64_t mask, uint32_t base, uint32_t* positions, size_t count) {
+    while (mask) {
+        positions[count++] = base + countTrailingZeros(mask);
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+static inline bool isSeparator(char c) {
+    return c == FIELD_SEPARATOR || c == '\n';
+}
+
+static size_t scanScalar(const char* data, size_t size, size_t offset, uint32_t* positions, size_t count) {
+    for (size_t i = offset; i < size; ++i) {
+        if (isSeparator(data[i])) {
+            positions[count++] = static_cast<uint32_t>(i);
+        }
+    }
+    return count;
+}
+
+static size_t scanSeparatorsScalar(const char* data, size_t size, uint32_t* positions) {
+    return scanScalar(data, size, 0, positions, 0);
+}
+
+#ifdef SEPARATOR_SCANNER_X86
+
+TARGET_SSE2
+static size_t scanSeparatorsSse2(const char* data, size_t size, uint32_t* positions) {
+    const __m128i field_separator = _mm_set1_epi8(FIELD_SEPARATOR);
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, field_separator), _mm_cmpeq_epi8(chunk, newline));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+        count = emitPositions(mask, static_cast<uint32_t>(i), positions, count);
+    }
+    return scanScalar(data, size, i, positions, count);
+}
+
+TARGET_AVX2
+static size_t scanSeparatorsAvx2(const char* data, size_t size, uint32_t* positions) {
+    const __m256i field_separator = _mm256_set1_epi8(FIELD_SEPARATOR);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t count = 0;
+    size_t i = 0;
+    // Two vectors per iteration give one 64-bit mask
+    for (; i + 64 <= size; i += 64) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        __m256i low_hits = _mm256_or_si256(_mm256_cmpeq_epi8(low, field_separator), _mm256_cmpeq_epi8(low, newline));
+        __m256i high_hits = _mm256_or_si256(_mm256_cmpeq_epi8(high, field_separator), _mm256_cmpeq_epi8(high, newline));
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(low_hits)) |
+                        (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high_hits))) << 32);
+        count = emitPositions(mask, static_cast<uint32_t>(i), positions, count);
+    }
+    return scanScalar(data, size, i, positions, count);
+}
+
+static bool cpuSupportsAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool cpuSupportsSse2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+#endif // SEPARATOR_SCANNER_X86
+
+#ifdef SEPARATOR_SCANNER_NEON
+
+static size_t scanSeparatorsNeon(const char* data, size_t size, uint32_t* positions) {
+    const uint8x16_t field_separator = vdupq_n_u8(FIELD_SEPARATOR);
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        uint8x16_t hits = vorrq_u8(vceqq_u8(chunk, field_separator), vceqq_u8(chunk, newline));
+        // Narrow to 4 bits per byte: bit 4*k is set when byte k matched
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+        mask &= 0x1111111111111111ULL;
+        while (mask) {
+            positions[count++] = static_cast<uint32_t>(i + countTrailingZeros(mask) / 4);
+            mask &= mask - 1;
+        }
+    }
+    return scanScalar(data, size, i, positions, count);
+}
+
+#endif // SEPARATOR_SCANNER_NEON
+
+using ScanFunction = size_t (*)(const char*, size_t, uint32_t*);
+
+struct ScannerImplementation {
+    ScanFunction scan;
+    const char* name;
+};
+
+static ScannerImplementation selectScanner() {
+#if defined(SEPARATOR_SCANNER_X86)
+    if (cpuSupportsAvx2()) {
+        return {scanSeparatorsAvx2, "avx2"};
+    }
+    if (cpuSupportsSse2()) {
+        return {scanSeparatorsSse2, "sse2"};
+    }
+#elif defined(SEPARATOR_SCANNER_NEON)
+    return {scanSeparatorsNeon, "neon"};
+#endif
+    return {scanSeparatorsScalar, "scalar"};
+}
+
+static const ScannerImplementation& scanner() {
+    static const ScannerImplementation implementation = selectScanner();
+    return implementation;
+}
+
+size_t scanSeparators(const char* data, size_t size, uint32_t* positions) {
+    return scanner().scan(data, size, positions);
+}
+
+const char* separatorScannerName() {
+    return scanner().name;
+}
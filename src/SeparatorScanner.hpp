@@ -0,0 +1,19 @@
+#ifndef SEPARATOR_SCANNER_HPP
+#define SEPARATOR_SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized search for field separators (ASCII 31) and newlines. The
+// implementation (AVX2, SSE2, NEON or scalar) is picked once at runtime
+// from what the CPU supports.
+
+// Write the offset of every FIELD_SEPARATOR and '\n' in data[0, size) to
+// positions, in ascending order, and return how many were found. positions
+// must have room for size entries; size must fit in 32 bits.
+size_t scanSeparators(const char* data, size_t size, uint32_t* positions);
+
+// Name of the implementation scanSeparators() dispatches to
+const char* separatorScannerName();
+
+#endif // SEPARATOR_SCANNER_HPP
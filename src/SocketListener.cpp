@@ -0,0 +1,349 @@
+#include "SocketListener.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#undef ERROR
+using SocketHandle = SOCKET;
+using PollDescriptor = WSAPOLLFD;
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+using SocketHandle = int;
+using PollDescriptor = pollfd;
+#endif
+
+static SocketHandle handleOf(uintptr_t socket) {
+    return static_cast<SocketHandle>(socket);
+}
+
+#ifdef _WIN32
+
+static bool startSockets() {
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+}
+
+static bool validSocket(SocketHandle socket) { return socket != INVALID_SOCKET; }
+static void closeSocket(SocketHandle socket) { closesocket(socket); }
+static bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static std::string socketError() { return "socket error " + std::to_string(WSAGetLastError()); }
+
+static int pollSockets(PollDescriptor* descriptors, size_t count, int timeout_ms) {
+    return WSAPoll(descriptors, static_cast<ULONG>(count), timeout_ms);
+}
+
+static void setNonBlocking(SocketHandle socket) {
+    u_long enabled = 1;
+    ioctlsocket(socket, FIONBIO, &enabled);
+}
+
+#else
+
+static bool startSockets() { return true; }
+static bool validSocket(SocketHandle socket) { return socket >= 0; }
+static void closeSocket(SocketHandle socket) { ::close(socket); }
+static bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+static std::string socketError() { return std::strerror(errno); }
+
+static int pollSockets(PollDescriptor* descriptors, size_t count, int timeout_ms) {
+    return ::poll(descriptors, static_cast<nfds_t>(count), timeout_ms);
+}
+
+static void setNonBlocking(SocketHandle socket) {
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+}
+
+#endif
+
+// "HOST:PORT" of a TCP address, without the IPv4-mapped prefix
+static std::string addressName(const sockaddr* address, socklen_t length, bool with_port) {
+    char host[NI_MAXHOST] = "";
+    char port[NI_MAXSERV] = "";
+    if (getnameinfo(address, length, host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV) != 0) {
+        return "unknown";
+    }
+    std::string name = host;
+    if (name.rfind("::ffff:", 0) == 0 && name.find('.') != std::string::npos) {
+        name.erase(0, 7);
+    }
+    if (!with_port) {
+        return name;
+    }
+    return (name.find(':') != std::string::npos ? "[" + name + "]" : name) + ":" + port;
+}
+
+SocketListener::~SocketListener() {
+    close();
+}
+
+bool SocketListener::isEndpoint(const std::string& text) {
+    return text.rfind("tcp://", 0) == 0 || text.rfind("unix:", 0) == 0;
+}
+
+bool SocketListener::open(const std::string& endpoint, std::string& error) {
+    close();
+    if (!startSockets()) {
+        error = "sockets are unavailable";
+        return false;
+    }
+
+    SocketHandle socket_handle;
+    if (endpoint.rfind("unix:", 0) == 0) {
+#ifdef _WIN32
+        error = "Unix sockets aren't supported on Windows";
+        return false;
+#else
+        std::string path = endpoint.substr(5);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            error = "invalid socket path";
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        // A socket left behind by a listener that's gone is replaced; a live one isn't
+        struct stat info;
+        if (lstat(path.c_str(), &info) == 0) {
+            if (!S_ISSOCK(info.st_mode)) {
+                error = path + " exists and isn't a socket";
+                return false;
+            }
+            SocketHandle probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            bool live = validSocket(probe) &&
+                        connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+            if (validSocket(probe)) {
+                closeSocket(probe);
+            }
+            if (live) {
+                error = path + " is in use";
+                return false;
+            }
+            unlink(path.c_str());
+        }
+
+        socket_handle = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (!validSocket(socket_handle) ||
+            bind(socket_handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(socket_handle, SOMAXCONN) != 0) {
+            error = socketError();
+            if (validSocket(socket_handle)) {
+                closeSocket(socket_handle);
+            }
+            return false;
+        }
+        unix_path = path;
+        bound_address = path;
+#endif
+    } else {
+        std::string address = endpoint.rfind("tcp://", 0) == 0 ? endpoint.substr(6) : endpoint;
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos) {
+            error = "expected tcp://HOST:PORT or unix:PATH";
+            return false;
+        }
+        std::string host = address.substr(0, colon);
+        std::string port = address.substr(colon + 1);
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+        if (port.empty() || port.find_first_not_of("0123456789") != std::string::npos) {
+            error = "invalid port '" + port + "'";
+            return false;
+        }
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* addresses = nullptr;
+        int status = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addresses);
+        if (status != 0) {
+            error = gai_strerror(status);
+            return false;
+        }
+
+        // IPv6 first: bound to every interface it takes IPv4 connections too
+        std::vector<const addrinfo*> candidates;
+        for (const addrinfo* candidate = addresses; candidate; candidate = candidate->ai_next) {
+            candidates.push_back(candidate);
+        }
+        std::stable_partition(candidates.begin(), candidates.end(),
+                              [](const addrinfo* candidate) { return candidate->ai_family == AF_INET6; });
+
+        bool bound = false;
+        for (const addrinfo* candidate : candidates) {
+            socket_handle = ::socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+            if (!validSocket(socket_handle)) {
+                error = socketError();
+                continue;
+            }
+            int option = 1;
+#ifndef _WIN32
+            // Restarting right after a run must not wait out TIME_WAIT
+            setsockopt(socket_handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&option), sizeof(option));
+#endif
+            if (candidate->ai_family == AF_INET6) {
+                option = 0;
+                setsockopt(socket_handle, IPPROTO_IPV6, IPV6_V6ONLY, reinterpret_cast<const char*>(&option), sizeof(option));
+            }
+            if (bind(socket_handle, candidate->ai_addr, static_cast<socklen_t>(candidate->ai_addrlen)) == 0 &&
+                listen(socket_handle, SOMAXCONN) == 0) {
+                bound = true;
+                break;
+            }
+            error = socketError();
+            closeSocket(socket_handle);
+        }
+        freeaddrinfo(addresses);
+        if (!bound) {
+            return false;
+        }
+
+        sockaddr_storage local{};
+        socklen_t length = sizeof(local);
+        getsockname(socket_handle, reinterpret_cast<sockaddr*>(&local), &length);
+        bound_address = addressName(reinterpret_cast<const sockaddr*>(&local), length, true);
+    }
+
+    // Accepting runs until it would block
+    setNonBlocking(socket_handle);
+    listen_socket = static_cast<uintptr_t>(socket_handle);
+    listening = true;
+    error.clear();
+    return true;
+}
+
+void SocketListener::close() {
+    for (Connection& connection : open_connections) {
+        if (!connection.closed) {
+            closeSocket(handleOf(connection.socket));
+        }
+    }
+    open_connections.clear();
+    if (listening) {
+        closeSocket(handleOf(listen_socket));
+        listening = false;
+    }
+#ifndef _WIN32
+    if (!unix_path.empty()) {
+        unlink(unix_path.c_str());
+    }
+#endif
+    unix_path.clear();
+    bound_address.clear();
+}
+
+bool SocketListener::poll(int timeout_ms, bool reading) {
+    if (!listening) {
+        return false;
+    }
+
+    // The listening socket, if there's room for more connections, then
+    // every connection with room in its buffer
+    std::vector<PollDescriptor> descriptors;
+    std::vector<size_t> watched;
+    bool accepting = open_connections.size() < MAX_CONNECTIONS;
+    if (accepting) {
+        PollDescriptor descriptor{};
+        descriptor.fd = handleOf(listen_socket);
+        descriptor.events = POLLIN;
+        descriptors.push_back(descriptor);
+    }
+    for (size_t i = 0; reading && i < open_connections.size(); ++i) {
+        const Connection& connection = open_connections[i];
+        if (!connection.closed && connection.received.size() < MAX_BUFFERED) {
+            PollDescriptor descriptor{};
+            descriptor.fd = handleOf(connection.socket);
+            descriptor.events = POLLIN;
+            descriptors.push_back(descriptor);
+            watched.push_back(i);
+        }
+    }
+    if (descriptors.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+        return false;
+    }
+
+    if (pollSockets(descriptors.data(), descriptors.size(), timeout_ms) <= 0) {
+        return false;
+    }
+
+    bool changed = false;
+    size_t first = accepting ? 1 : 0;
+    for (size_t k = 0; k < watched.size(); ++k) {
+        if (descriptors[first + k].revents & (POLLIN | POLLHUP | POLLERR)) {
+            receive(open_connections[watched[k]]);
+            changed = true;
+        }
+    }
+    if (accepting && (descriptors[0].revents & POLLIN)) {
+        size_t before = open_connections.size();
+        accept();
+        changed = changed || open_connections.size() != before;
+    }
+    return changed;
+}
+
+void SocketListener::removeClosed() {
+    open_connections.erase(std::remove_if(open_connections.begin(), open_connections.end(),
+                                          [](const Connection& connection) {
+                                              return connection.closed && connection.received.empty();
+                                          }),
+                           open_connections.end());
+}
+
+void SocketListener::accept() {
+    while (open_connections.size() < MAX_CONNECTIONS) {
+        sockaddr_storage address{};
+        socklen_t length = sizeof(address);
+        SocketHandle socket_handle = ::accept(handleOf(listen_socket), reinterpret_cast<sockaddr*>(&address), &length);
+        if (!validSocket(socket_handle)) {
+            return;
+        }
+        accepted++;
+
+        Connection connection;
+        connection.socket = static_cast<uintptr_t>(socket_handle);
+        connection.peer = unix_path.empty() ? addressName(reinterpret_cast<const sockaddr*>(&address), length, false)
+                                            : unix_path + "#" + std::to_string(accepted);
+        open_connections.push_back(std::move(connection));
+    }
+}
+
+void SocketListener::receive(Connection& connection) {
+    size_t old_size = connection.received.size();
+    size_t room = std::min(READ_BYTES, MAX_BUFFERED - old_size);
+    connection.received.resize(old_size + room);
+    auto count = recv(handleOf(connection.socket), &connection.received[old_size], static_cast<int>(room), 0);
+    if (count > 0) {
+        connection.received.resize(old_size + static_cast<size_t>(count));
+        received_bytes += static_cast<uint64_t>(count);
+        return;
+    }
+    connection.received.resize(old_size);
+    if (count < 0 && wouldBlock()) {
+        return;
+    }
+
+    // Closed by the peer, or reset
+    closeSocket(handleOf(connection.socket));
+    connection.closed = true;
+}
@@ -0,0 +1,79 @@
+#ifndef SOCKET_LISTENER_HPP
+#define SOCKET_LISTENER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Accepts connections from log forwarders on a TCP port or a Unix socket
+// and collects the bytes each one sends. Everything runs on the caller's
+// thread: poll() waits on all the sockets at once, accepts new connections
+// and reads whatever arrived. A connection whose buffer is full isn't read
+// until its bytes are taken, and none are read while poll() is told not
+// to; unread bytes then back up in the kernel's socket buffers until TCP
+// flow control stalls the forwarder, so memory stays bounded however fast
+// the senders write.
+class SocketListener {
+public:
+    struct Connection {
+        std::string peer;       // Sending host for TCP, "PATH#N" for Unix sockets
+        std::string received;   // Bytes read and not yet taken
+        bool closed = false;    // The peer is gone; received holds its last bytes
+        uintptr_t socket = 0;
+    };
+
+    // Most connections served at once; more wait in the listen backlog
+    static constexpr size_t MAX_CONNECTIONS = 256;
+
+    // Most bytes buffered per connection
+    static constexpr size_t MAX_BUFFERED = 4 * 1024 * 1024;
+
+    SocketListener() = default;
+    ~SocketListener();
+
+    SocketListener(const SocketListener&) = delete;
+    SocketListener& operator=(const SocketListener&) = delete;
+
+    // Listen on endpoint: "tcp://HOST:PORT", "tcp://:PORT" for every
+    // interface, or "unix:PATH" for a Unix socket (replacing a stale one).
+    // Returns false with the reason in error.
+    bool open(const std::string& endpoint, std::string& error);
+    void close();
+
+    // Whether text names an endpoint rather than a file
+    static bool isEndpoint(const std::string& text);
+
+    // "HOST:PORT" or the socket path listened on, with port 0's pick filled in
+    const std::string& address() const { return bound_address; }
+
+    // Wait for at most timeout_ms for new connections and, when reading,
+    // for bytes; accept the connections and append what arrived to their
+    // received buffers. Returns whether anything happened.
+    bool poll(int timeout_ms, bool reading);
+
+    // Open connections, and closed ones until removeClosed()
+    std::vector<Connection>& connections() { return open_connections; }
+
+    // Drop closed connections whose bytes have all been taken
+    void removeClosed();
+
+    // Bytes read from every connection so far
+    uint64_t bytesReceived() const { return received_bytes; }
+
+private:
+    static constexpr size_t READ_BYTES = 256 * 1024;
+
+    uintptr_t listen_socket = 0;
+    bool listening = false;
+    std::string unix_path;        // Removed again by close()
+    std::string bound_address;
+    std::vector<Connection> open_connections;
+    uint64_t accepted = 0;
+    uint64_t received_bytes = 0;
+
+    void accept();
+    void receive(Connection& connection);
+};
+
+#endif // SOCKET_LISTENER_HPP
@@ -0,0 +1,248 @@
+#include "SummaryWorker.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include <unordered_map>
+
+// Chunks are whole bitmap words so each is scanned straight from the level index
+static const size_t CHUNK_ROWS = 64 * 1024;
+
+// Groups kept per kind, most entries first
+static const size_t MAX_GROUPS = 100;
+
+// Bucket widths to choose from, in milliseconds; wider histograms use whole days
+static const int64_t BUCKET_WIDTHS[] = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500,
+    1000, 2000, 5000, 10000, 15000, 30000,
+    60000, 120000, 300000, 600000, 900000, 1800000,
+    3600000, 7200000, 10800000, 21600000, 43200000, TimeIndex::DAY_MS,
+};
+
+// One counting thread's share, added to the others at the end
+struct SummaryTally {
+    LevelCounts levels{};
+    std::vector<LevelCounts> files;       // By source file id
+    std::vector<LevelCounts> functions;   // By source function id
+    StringDictionary file_names;          // Lazy stores have no ids; these give them
+    StringDictionary function_names;
+    std::vector<uint64_t> buckets;
+    std::vector<uint64_t> error_buckets;
+};
+
+static void countGroup(std::vector<LevelCounts>& groups, uint32_t id, unsigned level) {
+    if (id >= groups.size()) {
+        groups.resize(id + 1);
+    }
+    groups[id][level]++;
+}
+
+// Narrowest width fitting [first, last] into max_buckets buckets
+static int64_t bucketWidth(int64_t first, int64_t last, size_t max_buckets) {
+    int64_t span = last - first + 1;
+    for (int64_t width : BUCKET_WIDTHS) {
+        // Buckets start on multiples of the width, so the first may start early
+        if ((last - first / width * width) / width + 1 <= static_cast<int64_t>(max_buckets)) {
+            return width;
+        }
+    }
+    int64_t days = (span + TimeIndex::DAY_MS * static_cast<int64_t>(max_buckets) - 1) /
+                   (TimeIndex::DAY_MS * static_cast<int64_t>(max_buckets));
+    return (days + 1) * TimeIndex::DAY_MS;
+}
+
+// Add up one kind of group across the tallies and keep the largest
+static std::vector<LogSummary::Group> mergeGroups(const std::vector<SummaryTally>& tallies,
+                                                  std::vector<LevelCounts> SummaryTally::*counts,
+                                                  StringDictionary SummaryTally::*names,
+                                                  const StringDictionary& store_names, bool lazy,
+                                                  size_t& distinct) {
+    std::unordered_map<std::string_view, LevelCounts> by_name;
+    for (const SummaryTally& tally : tallies) {
+        const std::vector<LevelCounts>& groups = tally.*counts;
+        for (size_t id = 0; id < groups.size(); ++id) {
+            uint64_t total = 0;
+            for (uint64_t count : groups[id]) total += count;
+            if (total == 0) continue;
+
+            std::string_view name = lazy ? (tally.*names)[static_cast<uint32_t>(id)]
+                                         : store_names[static_cast<uint32_t>(id)];
+            LevelCounts& merged = by_name[name];
+            for (size_t level = 0; level < merged.size(); ++level) {
+                merged[level] += groups[id][level];
+            }
+        }
+    }
+    distinct = by_name.size();
+
+    std::vector<LogSummary::Group> result;
+    result.reserve(by_name.size());
+    for (const auto& [name, levels] : by_name) {
+        LogSummary::Group group;
+        group.name = std::string(name);
+        group.levels = levels;
+        for (uint64_t count : levels) group.total += count;
+        result.push_back(std::move(group));
+    }
+    auto more = [](const LogSummary::Group& a, const LogSummary::Group& b) {
+        return a.total != b.total ? a.total > b.total : a.name < b.name;
+    };
+    if (result.size() > MAX_GROUPS) {
+        std::partial_sort(result.begin(), result.begin() + MAX_GROUPS, result.end(), more);
+        result.resize(MAX_GROUPS);
+    } else {
+        std::sort(result.begin(), result.end(), more);
+    }
+    return result;
+}
+
+SummaryWorker::~SummaryWorker() {
+    cancel();
+}
+
+void SummaryWorker::start(const LogStore& store, const LogFilter& filter, size_t max_buckets, DoneCallback on_done) {
+    cancel();
+
+    // Set before the thread starts so an immediate cancel() isn't lost
+    stop_requested = false;
+    running = true;
+    summary_thread = std::thread(&SummaryWorker::run, this, std::cref(store), filter, std::max<size_t>(1, max_buckets),
+                                 std::move(on_done));
+}
+
+void SummaryWorker::cancel() {
+    stop_requested = true;
+    if (summary_thread.joinable()) {
+        summary_thread.join();
+    }
+}
+
+std::shared_ptr<const LogSummary> SummaryWorker::result() const {
+    std::lock_guard<std::mutex> lock(result_mutex);
+    return latest;
+}
+
+void SummaryWorker::run(const LogStore& store, LogFilter filter, size_t max_buckets, DoneCallback on_done) {
+    auto started = std::chrono::steady_clock::now();
+    unsigned threads = thread_count;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The same rows and levels a FilterIndex would test
+    size_t rows = store.size();
+    const TimeIndex& clocks = store.timeIndex();
+    int64_t from = filter.rangeFrom();
+    int64_t to = filter.rangeTo();
+    size_t begin = from >= 0 ? clocks.seek(from, rows) : 0;
+    size_t end = to >= 0 ? std::max(begin, clocks.seek(to, rows)) : rows;
+    unsigned level_mask = filter.level_mask != 0 ? filter.level_mask : LevelIndex::ALL_LEVELS;
+    if (filter.query) {
+        level_mask &= filter.query->levelMask();
+    }
+
+    // Buckets span the range's clocks; rows logged out of order before
+    // its first row go in the first bucket
+    auto summary = std::make_shared<LogSummary>();
+    summary->rows = end - begin;
+    size_t bucket_count = 0;
+    if (begin < end) {
+        int64_t first_clock = clocks.clock(begin);
+        int64_t last_clock = std::max(first_clock, clocks.latest(end));
+        summary->bucket_ms = bucketWidth(first_clock, last_clock, max_buckets);
+        summary->bucket_start = first_clock / summary->bucket_ms * summary->bucket_ms;
+        bucket_count = static_cast<size_t>((last_clock - summary->bucket_start) / summary->bucket_ms + 1);
+    }
+
+    size_t first_chunk = begin / CHUNK_ROWS;
+    size_t chunk_count = end > begin ? (end + CHUNK_ROWS - 1) / CHUNK_ROWS - first_chunk : 0;
+    size_t worker_count = std::max<size_t>(1, std::min<size_t>(threads, chunk_count));
+    std::vector<SummaryTally> tallies(worker_count);
+    std::atomic<size_t> next_chunk{0};
+    const std::string& term = filter.search_term;
+    const Query* query = filter.query.get();
+    const bool lazy = store.isLazy();
+    const unsigned error_level = static_cast<unsigned>(LogLevel::ERROR);
+
+    auto worker = [&](SummaryTally& tally) {
+        tally.buckets.assign(bucket_count, 0);
+        tally.error_buckets.assign(bucket_count, 0);
+        const LevelIndex& levels = store.levelIndex();
+        for (size_t c = next_chunk++; c < chunk_count && !stop_requested; c = next_chunk++) {
+            size_t chunk_begin = std::max(begin, (first_chunk + c) * CHUNK_ROWS);
+            size_t chunk_end = std::min(end, (first_chunk + c + 1) * CHUNK_ROWS);
+            StageTimer timer(MetricStage::SUMMARY);
+            timer.addItems(chunk_end - chunk_begin);
+
+            // Clocks are followed through every row, matching or not
+            int64_t last = chunk_begin > 0 ? clocks.clock(chunk_begin - 1) : -1;
+            int64_t row_clock = 0;
+            size_t clocked = chunk_begin;
+
+            levels.forEachRow(level_mask, chunk_begin, chunk_end, [&](size_t row) {
+                if ((!term.empty() && store.message(row).find(term) == std::string_view::npos) ||
+                    (query && !query->matches(store, row))) {
+                    return;
+                }
+                unsigned level = static_cast<unsigned>(store.level(row));
+                tally.levels[level]++;
+                if (lazy) {
+                    LogEntryView entry = store[row];
+                    countGroup(tally.files, tally.file_names.intern(entry.source_file), level);
+                    countGroup(tally.functions, tally.function_names.intern(entry.source_function), level);
+                } else {
+                    countGroup(tally.files, store.sourceFileIds()[row], level);
+                    countGroup(tally.functions, store.sourceFunctionIds()[row], level);
+                }
+
+                while (clocked <= row) {
+                    row_clock = TimeIndex::advance(last, store.time(clocked++));
+                }
+                int64_t bucket = (row_clock - summary->bucket_start) / summary->bucket_ms;
+                size_t index = static_cast<size_t>(std::clamp<int64_t>(bucket, 0, bucket_count - 1));
+                tally.buckets[index]++;
+                if (level == error_level) {
+                    tally.error_buckets[index]++;
+                }
+            });
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < worker_count; ++i) {
+        workers.emplace_back(worker, std::ref(tallies[i]));
+    }
+    worker(tallies[0]);
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (!stop_requested) {
+        summary->buckets.assign(bucket_count, 0);
+        summary->error_buckets.assign(bucket_count, 0);
+        for (const SummaryTally& tally : tallies) {
+            for (size_t level = 0; level < tally.levels.size(); ++level) {
+                summary->levels[level] += tally.levels[level];
+                summary->entries += tally.levels[level];
+            }
+            for (size_t b = 0; b < bucket_count; ++b) {
+                summary->buckets[b] += tally.buckets[b];
+                summary->error_buckets[b] += tally.error_buckets[b];
+            }
+        }
+        summary->files = mergeGroups(tallies, &SummaryTally::files, &SummaryTally::file_names,
+                                     store.sourceFiles(), lazy, summary->file_count);
+        summary->functions = mergeGroups(tallies, &SummaryTally::functions, &SummaryTally::function_names,
+                                         store.sourceFunctions(), lazy, summary->function_count);
+        summary->elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        {
+            std::lock_guard<std::mutex> lock(result_mutex);
+            latest = std::move(summary);
+        }
+    }
+
+    running = false;
+    if (!stop_requested && on_done) {
+        on_done();
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef SUMMARY_WORKER_HPP
+#define SUMMARY_WORKER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FilterIndex.hpp"
+#include "LevelIndex.hpp"
+#include "LogStore.hpp"
+
+// Entries per LogLevel
+using LevelCounts = std::array<uint64_t, LevelIndex::LEVEL_COUNT>;
+
+// Grouped counts and a time histogram of the entries passing a filter
+struct LogSummary {
+    struct Group {
+        std::string name;
+        uint64_t total = 0;
+        LevelCounts levels{};
+    };
+
+    uint64_t entries = 0;
+    LevelCounts levels{};
+
+    // Source files and functions with the most entries, most first, and
+    // how many distinct ones there were in all
+    std::vector<Group> files;
+    std::vector<Group> functions;
+    size_t file_count = 0;
+    size_t function_count = 0;
+
+    // Entries, and ERROR entries, per bucket of bucket_ms starting at the
+    // clock bucket_start (TimeIndex clocks); empty when nothing matched
+    int64_t bucket_start = 0;
+    int64_t bucket_ms = 0;
+    std::vector<uint64_t> buckets;
+    std::vector<uint64_t> error_buckets;
+
+    size_t rows = 0;              // Store rows summarized
+    double elapsed_ms = 0;
+};
+
+// Background summary of the store's entries passing a filter, for the
+// summary panel. Chunks of rows are tested and counted on all cores, each
+// thread into its own tallies keyed by the store's dictionary ids, and the
+// tallies are added up once at the end, so there's no sharing while rows
+// are counted. Only the levels in the filter are visited, straight from
+// the level index; messages are read only for a search term or query.
+// start() and cancel() must come from the same thread, and the store must
+// outlive the summary (cancel() before clearing it).
+class SummaryWorker {
+public:
+    using DoneCallback = std::function<void()>;
+
+    ~SummaryWorker();
+
+    // Cancel any running summary and start one of the store's rows so far,
+    // with at most max_buckets time buckets. on_done is called from the
+    // worker once result() holds it.
+    void start(const LogStore& store, const LogFilter& filter, size_t max_buckets, DoneCallback on_done);
+
+    // Stop the running summary and wait for its threads; result() keeps
+    // the last finished one
+    void cancel();
+
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Last finished summary, or null
+    std::shared_ptr<const LogSummary> result() const;
+
+    // Counting threads (0 = all cores)
+    void setThreadCount(unsigned count) { thread_count = count; }
+
+private:
+    std::thread summary_thread;
+    std::atomic<bool> stop_requested{false};
+    std::atomic<bool> running{false};
+    unsigned thread_count = 0;
+    mutable std::mutex result_mutex;
+    std::shared_ptr<const LogSummary> latest;
+
+    void run(const LogStore& store, LogFilter filter, size_t max_buckets, DoneCallback on_done);
+};
+
+#endif // SUMMARY_WORKER_HPP
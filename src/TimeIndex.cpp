@@ -0,0 +1,124 @@
+#include "TimeIndex.hpp"
+#include "LineParser.hpp"
+#include <cstdio>
+
+TimeIndex::TimeIndex(const SegmentedColumn<int32_t>& times) : times(times) {
+    block_starts.push_back(-1);
+}
+
+void TimeIndex::extend(size_t rows) {
+    times.forEachSpan(indexed, rows, [&](const int32_t* values, size_t first, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            int64_t row_clock = advance(previous, values[i]);
+            maximum = row_clock > maximum ? row_clock : maximum;
+
+            // Block complete: publish its maximum and where the next one starts
+            if ((first + i + 1) % BLOCK_ROWS == 0) {
+                block_maxima.push_back(maximum);
+                block_starts.push_back(previous);
+            }
+        }
+    });
+    indexed = rows > indexed ? rows : indexed;
+}
+
+void TimeIndex::clear() {
+    block_maxima.clear();
+    block_starts.clear();
+    block_starts.push_back(-1);
+    previous = -1;
+    maximum = 0;
+    indexed = 0;
+}
+
+size_t TimeIndex::seek(int64_t clock, size_t rows) const {
+    // First complete block whose maximum reaches clock, else the tail
+    size_t low = 0;
+    size_t high = rows / BLOCK_ROWS;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (block_maxima[middle] >= clock) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    // Every row before this block is earlier, so the first one reaching
+    // clock in the block is the answer
+    size_t first = low * BLOCK_ROWS;
+    size_t end = rows < first + BLOCK_ROWS ? rows : first + BLOCK_ROWS;
+    int64_t last = block_starts[low];
+    int64_t block_maximum = low > 0 ? block_maxima[low - 1] : 0;
+    for (size_t row = first; row < end; ++row) {
+        int64_t row_clock = advance(last, times[row]);
+        block_maximum = row_clock > block_maximum ? row_clock : block_maximum;
+        if (block_maximum >= clock) {
+            return row;
+        }
+    }
+    return rows;
+}
+
+int64_t TimeIndex::clock(size_t row) const {
+    size_t first = row / BLOCK_ROWS * BLOCK_ROWS;
+    int64_t last = block_starts[row / BLOCK_ROWS];
+    int64_t row_clock = 0;
+    for (size_t i = first; i <= row; ++i) {
+        row_clock = advance(last, times[i]);
+    }
+    return row_clock;
+}
+
+int64_t TimeIndex::latest(size_t rows) const {
+    if (rows == 0) {
+        return 0;
+    }
+    // Complete blocks are in the directory; the partial one is scanned
+    size_t block = rows / BLOCK_ROWS;
+    int64_t last = block_starts[block];
+    int64_t result = block > 0 ? block_maxima[block - 1] : 0;
+    for (size_t row = block * BLOCK_ROWS; row < rows; ++row) {
+        int64_t row_clock = advance(last, times[row]);
+        result = row_clock > result ? row_clock : result;
+    }
+    return result;
+}
+
+int64_t TimeIndex::parseClock(std::string_view text) {
+    size_t plus = text.find('+');
+    int32_t time = parseTimeOfDay(text.substr(0, plus));
+    if (time < 0) {
+        return -1;
+    }
+
+    int64_t day = 0;
+    if (plus != std::string_view::npos) {
+        std::string_view digits = text.substr(plus + 1);
+        if (digits.empty() || digits.size() > 6) {
+            return -1;
+        }
+        for (char c : digits) {
+            if (c < '0' || c > '9') {
+                return -1;
+            }
+            day = day * 10 + (c - '0');
+        }
+    }
+    return day * DAY_MS + time;
+}
+
+std::string TimeIndex::formatClock(int64_t clock) {
+    int64_t day = clock / DAY_MS;
+    int64_t ms = clock % DAY_MS;
+    char text[40];
+    int length = std::snprintf(text, sizeof(text), "%02d:%02d:%02d", static_cast<int>(ms / 3600000),
+                               static_cast<int>(ms / 60000 % 60), static_cast<int>(ms / 1000 % 60));
+    if (ms % 1000 != 0) {
+        length += std::snprintf(text + length, sizeof(text) - length, ".%03d", static_cast<int>(ms % 1000));
+    }
+    if (day > 0) {
+        std::snprintf(text + length, sizeof(text) - length, "+%lld", static_cast<long long>(day));
+    }
+    return text;
+}
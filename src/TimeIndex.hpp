@@ -0,0 +1,77 @@
+#ifndef TIME_INDEX_HPP
+#define TIME_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "SegmentedColumn.hpp"
+
+// Seek index over a store's time-of-day column. Each row gets a clock:
+// milliseconds since midnight of the log's first day, where a time more
+// than ROLLOVER_MS earlier than the previous row's starts the next day.
+// Rows without a time take the clock of the row before them.
+//
+// Logs written by several threads aren't strictly ordered, so seeks use
+// the running maximum of the clock: seek(clock) is the first row at or
+// after that time, found by binary search over per-block maxima and then
+// a scan of one block. Like the store, one writer extends the index while
+// readers query any row count up to LogStore::size().
+class TimeIndex {
+public:
+    static constexpr int64_t DAY_MS = 24 * 60 * 60 * 1000;
+    static constexpr int32_t ROLLOVER_MS = 12 * 60 * 60 * 1000;
+
+    explicit TimeIndex(const SegmentedColumn<int32_t>& times);
+
+    // Index time column rows up to rows (writer only)
+    void extend(size_t rows);
+    void clear();
+
+    // First row among the first rows whose running maximum clock reaches
+    // clock; rows if none does
+    size_t seek(int64_t clock, size_t rows) const;
+
+    // Clock of a row below LogStore::size()
+    int64_t clock(size_t row) const;
+
+    // Latest clock among the first rows, 0 if there are none
+    int64_t latest(size_t rows) const;
+
+    // Parse "HH:MM:SS[.fff]" with an optional "+N" day suffix into a clock.
+    // Returns -1 if the text isn't a time.
+    static int64_t parseClock(std::string_view text);
+
+    // "HH:MM:SS", with ".fff" unless the clock is a whole second and "+N"
+    // after the first day; parseClock() reads it back
+    static std::string formatClock(int64_t clock);
+
+    // Clock for a row's time given the last valid clock before it (-1 for
+    // the first row), which is updated. For following rows one at a time.
+    static int64_t advance(int64_t& previous, int32_t time) {
+        if (time < 0) {
+            return previous < 0 ? 0 : previous;
+        }
+        int64_t day = previous < 0 ? 0 : previous / DAY_MS;
+        if (previous >= 0 && time + ROLLOVER_MS < previous % DAY_MS) {
+            day++;
+        }
+        previous = day * DAY_MS + time;
+        return previous;
+    }
+
+private:
+    // Rows per block of the seek directory
+    static constexpr size_t BLOCK_ROWS = 1024;
+
+    const SegmentedColumn<int32_t>& times;
+    SegmentedColumn<int64_t> block_maxima;   // Running maximum clock through the end of each block
+    SegmentedColumn<int64_t> block_starts;   // Last valid clock before each block, -1 if none
+
+    // Writer state
+    int64_t previous = -1;
+    int64_t maximum = 0;
+    size_t indexed = 0;
+};
+
+#endif // TIME_INDEX_HPP
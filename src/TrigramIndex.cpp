@@ -0,0 +1,238 @@
+#include "TrigramIndex.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+
+// Rows are packed below the trigram in 64-bit sort keys
+static const unsigned ROW_BITS = 40;
+
+static uint32_t trigramAt(std::string_view text, size_t position) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(text[position])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(text[position + 1])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(text[position + 2]));
+}
+
+void TrigramIndex::PostingList::add(size_t row) {
+    // First posting is absolute, the rest are gaps from the previous row
+    size_t value = count == 0 ? row : row - last_row;
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+
+    if (count % SKIP_INTERVAL == 0) {
+        skips.push_back(Skip{row, bytes.size()});
+    }
+    last_row = row;
+    count++;
+}
+
+TrigramIndex::Cursor::Cursor(const PostingList& list) : list(list) {
+    if (list.count > 0) {
+        index = static_cast<size_t>(-1);
+        next();
+    }
+}
+
+void TrigramIndex::Cursor::next() {
+    index++;
+    if (index >= list.count) return;
+
+    size_t value = 0;
+    unsigned shift = 0;
+    uint8_t byte;
+    do {
+        byte = list.bytes[offset++];
+        value |= static_cast<size_t>(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    current = index == 0 ? value : current + value;
+}
+
+void TrigramIndex::Cursor::seek(size_t target) {
+    if (atEnd() || current >= target) return;
+
+    // Jump to the last skip entry at or before target, if it's ahead of us
+    auto skip = std::upper_bound(list.skips.begin(), list.skips.end(), target,
+                                 [](size_t row, const Skip& entry) { return row < entry.row; });
+    if (skip != list.skips.begin()) {
+        --skip;
+        size_t skip_index = static_cast<size_t>(skip - list.skips.begin()) * SKIP_INTERVAL;
+        if (skip_index > index) {
+            index = skip_index;
+            offset = skip->offset;
+            current = skip->row;
+        }
+    }
+    while (!atEnd() && current < target) {
+        next();
+    }
+}
+
+TrigramIndex::~TrigramIndex() {
+    cancel();
+}
+
+void TrigramIndex::build(const LogStore& store, size_t rows, ProgressCallback on_done) {
+    cancel();
+
+    store_generation = store.generation();
+    indexed_rows = rows;
+
+    // Set before the thread starts so an immediate cancel() isn't lost
+    stop_requested = false;
+    building = true;
+    build_thread = std::thread(&TrigramIndex::run, this, std::cref(store), rows, std::move(on_done));
+}
+
+void TrigramIndex::cancel() {
+    stop_requested = true;
+    if (build_thread.joinable()) {
+        build_thread.join();
+    }
+    ready = false;
+    postings.clear();
+    indexed_rows = 0;
+}
+
+void TrigramIndex::run(const LogStore& store, size_t rows, ProgressCallback on_done) {
+    unsigned threads = thread_count;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Workers turn chunks of rows into sorted, deduplicated (trigram, row)
+    // keys; one merger appends them to the posting lists in row order
+    const size_t CHUNK_ROWS = 16 * 1024;
+    size_t chunk_count = (rows + CHUNK_ROWS - 1) / CHUNK_ROWS;
+
+    std::vector<std::optional<std::vector<uint64_t>>> results(chunk_count);
+    std::mutex results_mutex;
+    std::condition_variable chunk_done;
+    std::atomic<size_t> next_chunk{0};
+
+    auto worker = [&]() {
+        for (size_t c = next_chunk++; c < chunk_count; c = next_chunk++) {
+            std::vector<uint64_t> keys;
+
+            // Cancelled chunks are still marked done so the merger never blocks
+            if (!stop_requested) {
+                size_t end = std::min(rows, (c + 1) * CHUNK_ROWS);
+                StageTimer timer(MetricStage::INDEX);
+                timer.addItems(end - c * CHUNK_ROWS);
+                for (size_t row = c * CHUNK_ROWS; row < end; ++row) {
+                    std::string_view message = store.message(row);
+                    for (size_t i = 0; i + 3 <= message.size(); ++i) {
+                        keys.push_back((static_cast<uint64_t>(trigramAt(message, i)) << ROW_BITS) | row);
+                    }
+                }
+                std::sort(keys.begin(), keys.end());
+                keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(results_mutex);
+                results[c] = std::move(keys);
+            }
+            chunk_done.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    size_t worker_count = std::min<size_t>(threads, chunk_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(worker);
+    }
+
+    const uint64_t ROW_MASK = (uint64_t(1) << ROW_BITS) - 1;
+    for (size_t c = 0; c < chunk_count; ++c) {
+        std::optional<std::vector<uint64_t>> keys;
+        {
+            std::unique_lock<std::mutex> lock(results_mutex);
+            chunk_done.wait(lock, [&] { return results[c].has_value(); });
+            keys.swap(results[c]);
+        }
+        if (stop_requested) continue;
+
+        // Keys are grouped by trigram, so each list is looked up once per chunk
+        PostingList* list = nullptr;
+        uint32_t list_trigram = 0;
+        for (uint64_t key : *keys) {
+            uint32_t trigram = static_cast<uint32_t>(key >> ROW_BITS);
+            if (!list || trigram != list_trigram) {
+                list = &postings[trigram];
+                list_trigram = trigram;
+            }
+            list->add(static_cast<size_t>(key & ROW_MASK));
+        }
+    }
+
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (stop_requested) {
+        building = false;
+        return;
+    }
+    for (auto& entry : postings) {
+        entry.second.bytes.shrink_to_fit();
+        entry.second.skips.shrink_to_fit();
+    }
+    ready = true;
+    building = false;
+    if (on_done) {
+        on_done();
+    }
+}
+
+bool TrigramIndex::candidates(std::string_view term, std::vector<size_t>& rows) const {
+    rows.clear();
+    if (term.size() < 3) {
+        return false;
+    }
+
+    // Every list the term needs, shortest first
+    std::vector<const PostingList*> lists;
+    for (size_t i = 0; i + 3 <= term.size(); ++i) {
+        auto it = postings.find(trigramAt(term, i));
+        if (it == postings.end()) {
+            return true;
+        }
+        if (std::find(lists.begin(), lists.end(), &it->second) == lists.end()) {
+            lists.push_back(&it->second);
+        }
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const PostingList* a, const PostingList* b) { return a->count < b->count; });
+
+    // Start from the rarest trigram and keep rows present in every other list
+    for (Cursor cursor(*lists[0]); !cursor.atEnd(); cursor.next()) {
+        rows.push_back(cursor.row());
+    }
+    for (size_t l = 1; l < lists.size() && !rows.empty(); ++l) {
+        Cursor cursor(*lists[l]);
+        size_t kept = 0;
+        for (size_t row : rows) {
+            cursor.seek(row);
+            if (cursor.atEnd()) break;
+            if (cursor.row() == row) {
+                rows[kept++] = row;
+            }
+        }
+        rows.resize(kept);
+    }
+    return true;
+}
+
+size_t TrigramIndex::memoryBytes() const {
+    size_t total = 0;
+    for (const auto& entry : postings) {
+        total += sizeof(entry) + entry.second.bytes.capacity() +
+                 entry.second.skips.capacity() * sizeof(Skip);
+    }
+    return total;
+}
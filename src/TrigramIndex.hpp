@@ -0,0 +1,100 @@
+#ifndef TRIGRAM_INDEX_HPP
+#define TRIGRAM_INDEX_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "LogStore.hpp"
+
+// Inverted index from every 3-byte substring of a message to the rows
+// containing it. Any row whose message contains a search term of three or
+// more bytes contains all of the term's trigrams, so intersecting their
+// posting lists gives a small candidate set to verify with a real find().
+//
+// Posting lists are delta/varint encoded with a skip entry every
+// SKIP_INTERVAL rows, so intersections jump over runs that can't match.
+// The index is built once, in the background, over a prefix of the store;
+// it can only be queried after isReady(), and is immutable from then on.
+class TrigramIndex {
+public:
+    using ProgressCallback = std::function<void()>;
+
+    ~TrigramIndex();
+
+    // Drop any current index and start indexing rows [0, rows) of store.
+    // on_done is called from the build thread once the index is ready.
+    void build(const LogStore& store, size_t rows, ProgressCallback on_done);
+
+    // Stop a running build and drop the index. Call before clearing the store.
+    void cancel();
+
+    bool isReady() const { return ready.load(std::memory_order_acquire); }
+    bool isBuilding() const { return building.load(std::memory_order_acquire); }
+
+    // What a ready or building index covers
+    uint64_t generation() const { return store_generation; }
+    size_t rows() const { return indexed_rows; }
+
+    // Rows that may contain term, ascending. Returns false when term is too
+    // short for the index and every row is a candidate.
+    bool candidates(std::string_view term, std::vector<size_t>& rows) const;
+
+    // Bytes held by posting lists and skip entries
+    size_t memoryBytes() const;
+
+    // Build threads (0 = all cores)
+    void setThreadCount(unsigned count) { thread_count = count; }
+
+private:
+    static constexpr size_t SKIP_INTERVAL = 64;
+
+    struct Skip {
+        size_t row;         // Row of posting index * SKIP_INTERVAL
+        size_t offset;      // Byte offset just past its encoding
+    };
+
+    struct PostingList {
+        std::vector<uint8_t> bytes;
+        std::vector<Skip> skips;
+        size_t count = 0;
+        size_t last_row = 0;
+
+        void add(size_t row);
+    };
+
+    // Walks one posting list in row order
+    class Cursor {
+    public:
+        explicit Cursor(const PostingList& list);
+
+        bool atEnd() const { return index >= list.count; }
+        size_t row() const { return current; }
+
+        // Advance to the next posting, or to the first posting >= target
+        void next();
+        void seek(size_t target);
+
+    private:
+        const PostingList& list;
+        size_t index = 0;
+        size_t offset = 0;
+        size_t current = 0;
+    };
+
+    std::unordered_map<uint32_t, PostingList> postings;
+    std::thread build_thread;
+    std::atomic<bool> stop_requested{false};
+    std::atomic<bool> building{false};
+    std::atomic<bool> ready{false};
+    uint64_t store_generation = 0;
+    size_t indexed_rows = 0;
+    unsigned thread_count = 0;
+
+    void run(const LogStore& store, size_t rows, ProgressCallback on_done);
+};
+
+#endif // TRIGRAM_INDEX_HPP
@@ -1,13 +1,29 @@
 #include "ftxui/component/component.hpp"
 #include "ftxui/component/screen_interactive.hpp"
 #include "ftxui/dom/elements.hpp"
+#include "ftxui/screen/terminal.hpp"
+#include "Cli.hpp"
+#include "DiagnosticLog.hpp"
+#include "ExportWorker.hpp"
 #include "LogParser.hpp"
 #include "LogEntry.hpp"
+#include "FilterIndex.hpp"
+#include "TrigramIndex.hpp"
+#include "TimeIndex.hpp"
+#include "Metrics.hpp"
+#include "Query.hpp"
+#include "SocketListener.hpp"
+#include "SummaryWorker.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <fstream>
 #include <filesystem>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <unordered_map>
+#include <cstdlib>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -53,13 +69,72 @@ std::string getConfigPath() {
     return "logreader_config.txt";
 }
 
+// Whether name matches a wildcard pattern with * and ?
+bool matchesWildcard(std::string_view pattern, std::string_view name) {
+    size_t p = 0, n = 0;
+    size_t star = std::string_view::npos, star_n = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            p++;
+            n++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_n = n;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++star_n;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') p++;
+    return p == pattern.size();
+}
+
+// Files named by the file input: the text itself if it names a file,
+// otherwise a whitespace-separated list of paths where the file name part
+// may contain * and ? wildcards (e.g. "logs/*.log")
+std::vector<std::string> expandInputPaths(const std::string& text) {
+    if (std::filesystem::is_regular_file(text)) {
+        return {text};
+    }
+    
+    std::vector<std::string> paths;
+    std::istringstream words(text);
+    std::string word;
+    while (words >> word) {
+        std::filesystem::path pattern(word);
+        std::string name = pattern.filename().string();
+        if (name.find_first_of("*?") == std::string::npos) {
+            paths.push_back(word);
+            continue;
+        }
+        
+        std::filesystem::path directory = pattern.has_parent_path() ? pattern.parent_path() : ".";
+        std::vector<std::string> matches;
+        std::error_code error;
+        for (const auto& item : std::filesystem::directory_iterator(directory, error)) {
+            if (item.is_regular_file(error) && matchesWildcard(name, item.path().filename().string())) {
+                matches.push_back((pattern.has_parent_path() ? item.path() : item.path().filename()).string());
+            }
+        }
+        std::sort(matches.begin(), matches.end());
+        paths.insert(paths.end(), matches.begin(), matches.end());
+    }
+    return paths;
+}
+
 std::string loadLastFilePath() {
     std::ifstream config(getConfigPath());
     if (config.is_open()) {
         std::string path;
         std::getline(config, path);
         config.close();
-        if (!path.empty() && std::filesystem::exists(path)) {
+        std::vector<std::string> paths = expandInputPaths(path);
+        bool all_exist = std::all_of(paths.begin(), paths.end(), [](const std::string& file) {
+            return std::filesystem::exists(file);
+        });
+        if (!paths.empty() && all_exist) {
             return path;
         }
     }
@@ -74,45 +149,6 @@ void saveLastFilePath(const std::string& path) {
     }
 }
 
-// =============================================================================
-// Clipboard functionality
-// =============================================================================
-
-bool copyToClipboard(const std::string& text) {
-#ifdef _WIN32
-    if (!OpenClipboard(nullptr)) {
-        return false;
-    }
-    
-    EmptyClipboard();
-    
-    size_t size = (text.length() + 1) * sizeof(char);
-    HGLOBAL hClipboardData = GlobalAlloc(GMEM_MOVEABLE, size);
-    if (!hClipboardData) {
-        CloseClipboard();
-        return false;
-    }
-    
-    char* pchData = static_cast<char*>(GlobalLock(hClipboardData));
-    if (!pchData) {
-        GlobalFree(hClipboardData);
-        CloseClipboard();
-        return false;
-    }
-    
-    strcpy_s(pchData, size, text.c_str());
-    GlobalUnlock(hClipboardData);
-    
-    SetClipboardData(CF_TEXT, hClipboardData);
-    CloseClipboard();
-    return true;
-#else
-    // Linux: Use xclip if available, otherwise try xsel
-    std::string command = "echo '" + text + "' | xclip -selection clipboard 2>/dev/null || echo '" + text + "' | xsel --clipboard --input 2>/dev/null";
-    return system(command.c_str()) == 0;
-#endif
-}
-
 // =============================================================================
 // Helper functions for log display
 // =============================================================================
@@ -141,11 +177,131 @@ Color LogLevelToColor(LogLevel level) {
     }
 }
 
+// A row's message can't show more than the terminal's width in glyphs, and
+// a glyph is at most 4 bytes, so keep only that much of very long messages
+// (without splitting a UTF-8 sequence)
+std::string clipToWidth(std::string_view text, int width) {
+    size_t limit = static_cast<size_t>(std::max(width, 1)) * 4;
+    if (text.size() <= limit) {
+        return std::string(text);
+    }
+    while (limit > 0 && (static_cast<unsigned char>(text[limit]) & 0xC0) == 0x80) {
+        limit--;
+    }
+    return std::string(text.substr(0, limit));
+}
+
+Element buildHeader(bool merged) {
+    Elements cells;
+    if (merged) {
+        cells.push_back(text("Origin") | bold | color(Color::RGB(255, 215, 0)) | size(WIDTH, EQUAL, 20));
+        cells.push_back(separator());
+    }
+    cells.push_back(text("Timestamp") | bold | color(Color::RGB(255, 215, 0)) | center | size(WIDTH, EQUAL, 15));
+    cells.push_back(separator());
+    cells.push_back(text("Level") | bold | color(Color::RGB(255, 215, 0)) | center | size(WIDTH, EQUAL, 10));
+    cells.push_back(separator());
+    cells.push_back(text("Message") | bold | color(Color::RGB(255, 215, 0)) | flex);
+    cells.push_back(separator());
+    cells.push_back(text("Source") | bold | color(Color::RGB(255, 215, 0)) | size(WIDTH, EQUAL, 50));
+    return hbox(std::move(cells));
+}
+
+// Rows drawn in the last frame, by store row. Rows below the store's size
+// never change until it's cleared, so a row stays built for as long as it
+// remains on screen and scrolling by a line builds only the new one.
+class RowCache {
+public:
+    // Start a frame; rows built for another store, width or layout are dropped
+    void beginFrame(uint64_t generation, int width, bool merged) {
+        if (generation != cached_generation || width != cached_width || merged != cached_merged) {
+            current.clear();
+            cached_generation = generation;
+            cached_width = width;
+            cached_merged = merged;
+        }
+        previous.swap(current);
+        current.clear();
+    }
+
+    // The row's element from the last frame, or build() for a new one
+    template <typename Build>
+    Element row(size_t row, Build&& build) {
+        auto found = previous.find(row);
+        Element element = found != previous.end() ? found->second : build();
+        current.emplace(row, element);
+        return element;
+    }
+
+private:
+    std::unordered_map<size_t, Element> previous;
+    std::unordered_map<size_t, Element> current;
+    uint64_t cached_generation = 0;
+    int cached_width = -1;
+    bool cached_merged = false;
+};
+
 // =============================================================================
 // Main application
 // =============================================================================
 
-int main() {
+// Milliseconds with two decimals, for the stats overlay
+std::string formatMs(uint64_t ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.2f", ns / 1e6);
+    return text;
+}
+
+std::string formatMb(size_t bytes) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f MB", bytes / (1024.0 * 1024.0));
+    return text;
+}
+
+// "30s", "5m", "500ms": a histogram bucket's width
+std::string formatWidth(int64_t ms) {
+    if (ms % 3600000 == 0) return std::to_string(ms / 3600000) + "h";
+    if (ms % 60000 == 0) return std::to_string(ms / 60000) + "m";
+    if (ms % 1000 == 0) return std::to_string(ms / 1000) + "s";
+    return std::to_string(ms) + "ms";
+}
+
+// One block per value, as tall as its share of the largest; blank for none
+std::string sparkline(const std::vector<uint64_t>& values, uint64_t peak) {
+    static const char* const BLOCKS[] = {"\u2581", "\u2582", "\u2583", "\u2584",
+                                         "\u2585", "\u2586", "\u2587", "\u2588"};
+    std::string line;
+    for (uint64_t value : values) {
+        line += value == 0 ? " " : BLOCKS[std::min<uint64_t>(7, (value * 8 - 1) / std::max<uint64_t>(1, peak))];
+    }
+    return line;
+}
+
+int main(int argc, char* argv[]) {
+    // LOGREADER_TRACE=file.json records every timed stage and writes a
+    // Chrome trace on exit
+    const char* trace_path = std::getenv("LOGREADER_TRACE");
+    if (trace_path) {
+        startTrace();
+    }
+    
+    // LOGREADER_DIAG=debug|info|warn|error|off sets which of the reader's
+    // own diagnostics reach logreader_debug.log
+    DiagnosticLevel diagnostic_level;
+    const char* diagnostics = std::getenv("LOGREADER_DIAG");
+    if (diagnostics && parseDiagnosticLevel(diagnostics, diagnostic_level)) {
+        setDiagnosticLevel(diagnostic_level);
+    }
+    
+    // Any arguments select the headless batch mode
+    if (argc > 1) {
+        int status = runCli(argc, argv);
+        if (trace_path && !writeChromeTrace(trace_path)) {
+            std::fprintf(stderr, "log_reader: cannot write trace %s\n", trace_path);
+        }
+        return status;
+    }
+    
 #ifdef _WIN32
     enableWindowsConsoleColors();
 #endif
@@ -155,12 +311,34 @@ int main() {
     // -------------------------------------------------------------------------
     // Application state
     // -------------------------------------------------------------------------
-    std::vector<LogEntry> log_entries;
-    std::mutex log_entries_mutex;
+    LogStore log_store;              // Entries and their text (mapping or arenas)
+    std::mutex log_entries_mutex;    // Serializes parser appends with clearing the store
+    bool use_mmap = false;           // Load the next file memory-mapped
+    bool use_lazy = false;           // Decode mapped rows only when they're read
+    bool use_index = false;          // Build a trigram index once a file has loaded
+    bool use_follow = false;         // Keep reading lines appended to the next file
+    bool show_stats = false;         // Stage timings and memory over the log view
+    bool show_summary = false;       // Counts per level, source and time over the log view
     std::string input_file_path = loadLastFilePath();
     std::string search_term;
+    std::string export_path;
+    std::string time_text;           // "HH:MM:SS" to jump to, or "from-to" to filter
+    int64_t time_from = -1;          // Time range filter (TimeIndex clocks, -1 for open)
+    int64_t time_to = -1;
+    int64_t seek_clock = -1;         // Jump pending for the next frame
+    int seek_percent = -1;           // Jump to this far through the filtered rows, pending
     std::string status_message = "Ready";
     int scroll_y = 0;
+    int last_filtered = 0;           // Filtered rows in the previous frame
+    int visible_rows = 1;            // Rows the log view fit in the previous frame
+    Box log_box;                     // Where the log rows were drawn in the previous frame
+    int log_box_height = -1;         // Terminal height log_box was measured at
+    
+    // Heights of the panes around the log view, shared by the layout and
+    // the estimate of the rows it fits until it has been drawn
+    const int FILE_PANE_HEIGHT = 5;
+    const int SEARCH_PANE_HEIGHT = 6;
+    const int LOG_PANE_CHROME = 6;   // Border, status line, header and their separators
     
     // Filter states
     bool show_debug = false;
@@ -171,106 +349,279 @@ int main() {
     // -------------------------------------------------------------------------
     // Create UI components
     // -------------------------------------------------------------------------
-    auto input_file = Input(&input_file_path, "path/to/log.txt");
-    auto input_search = Input(&search_term, "search term");
+    auto input_file = Input(&input_file_path, "path/to/log.txt, logs/*.log or tcp://:5140");
+    auto input_search = Input(&search_term, "search term or query, e.g. level>=WARN AND msg~\"time(out)?\"");
+    auto input_export = Input(&export_path, "file to write the filtered entries to");
     
     // Create parser instance
     LogParser parser;
     
-    auto parse_button = Button("Open", [&] {
-        // Clear existing entries
-        {
-            std::lock_guard<std::mutex> lock(log_entries_mutex);
-            log_entries.clear();
+    // LOGREADER_SCHEMA=standard|thread|frame sets the field layout of the
+    // files opened
+    LogSchemaId schema;
+    const char* schema_name = std::getenv("LOGREADER_SCHEMA");
+    if (schema_name && parseLogSchemaName(schema_name, schema)) {
+        parser.setSchema(schema);
+    }
+    
+    // Filtered view of the store, recomputed only when the filter changes
+    // and extended as the parser appends entries. Searches run in the
+    // background and repaint the view as matches arrive.
+    FilterIndex filter_index;
+    filter_index.setProgressCallback([&] { screen.PostEvent(Event::Custom); });
+    
+    // Optional trigram index over messages, built in the background after
+    // a load finishes so repeated searches only verify candidate rows
+    TrigramIndex trigram_index;
+    filter_index.setTrigramIndex(&trigram_index);
+    
+    // Copy Filtered and Export run here
+    ExportWorker export_worker;
+    
+    // The summary panel's counts, recounted in the background
+    SummaryWorker summary_worker;
+    
+    // The search box holds plain text or a query (see Query::isQuery());
+    // a query is compiled once when the text changes, not every frame
+    std::string compiled_text;
+    std::shared_ptr<const Query> compiled_query;
+    auto current_filter = [&]() {
+        LogFilter filter;
+        filter.level_mask = (show_debug ? 1u << static_cast<int>(LogLevel::DEBUG) : 0) |
+                            (show_info ? 1u << static_cast<int>(LogLevel::INFO) : 0) |
+                            (show_warn ? 1u << static_cast<int>(LogLevel::WARN) : 0) |
+                            (show_error ? 1u << static_cast<int>(LogLevel::ERROR) : 0);
+        if (search_term != compiled_text) {
+            compiled_text = search_term;
+            compiled_query = nullptr;
+            if (Query::isQuery(search_term)) {
+                std::string error;
+                compiled_query = Query::compile(search_term, error);
+                if (!compiled_query) {
+                    status_message = "Query error: " + error + " (searching for the text instead)";
+                }
+            }
         }
-        scroll_y = 0;
-        
-        // Start async parsing with progress callback
-        parser.parseAsync(input_file_path, log_entries, log_entries_mutex, 
-                         [&](const std::string& progress) {
-                             status_message = progress;
-                             // Force UI refresh
-                             screen.PostEvent(Event::Custom);
-                         });
-        
-        saveLastFilePath(input_file_path);
-        input_search->TakeFocus();
+        if (compiled_query) {
+            filter.query = compiled_query;
+        } else {
+            filter.search_term = search_term;
+        }
+        filter.time_from = time_from;
+        filter.time_to = time_to;
+        return filter;
+    };
+    
+    // Enter in the time input: "HH:MM:SS[.fff][+day]" jumps to the first
+    // entry at or after that time, "from-to" (either end may be empty)
+    // shows only that range, "NN%" jumps that far through the view, and
+    // an empty input clears the range
+    auto apply_time = [&] {
+        size_t dash = time_text.find('-');
+        if (time_text.empty()) {
+            time_from = time_to = -1;
+            status_message = "Time range cleared";
+        } else if (time_text.back() == '%') {
+            char* end = nullptr;
+            long percent = std::strtol(time_text.c_str(), &end, 10);
+            if (end != time_text.c_str() + time_text.size() - 1 || percent < 0 || percent > 100) {
+                status_message = "Invalid percentage: " + time_text;
+            } else {
+                seek_percent = static_cast<int>(percent);
+            }
+        } else if (dash == std::string::npos) {
+            seek_clock = TimeIndex::parseClock(time_text);
+            if (seek_clock < 0) {
+                status_message = "Invalid time: " + time_text;
+            }
+        } else {
+            std::string from = time_text.substr(0, dash);
+            std::string to = time_text.substr(dash + 1);
+            int64_t from_clock = from.empty() ? -1 : TimeIndex::parseClock(from);
+            int64_t to_clock = to.empty() ? -1 : TimeIndex::parseClock(to);
+            if ((!from.empty() && from_clock < 0) || (!to.empty() && to_clock < 0)) {
+                status_message = "Invalid time range: " + time_text;
+            } else {
+                time_from = from_clock;
+                time_to = to_clock;
+                scroll_y = 0;
+                status_message = "Time range: " + time_text;
+            }
+        }
+        screen.PostEvent(Event::Custom);
+    };
+    auto input_time = Input(&time_text, "HH:MM:SS, from-to or NN%") | CatchEvent([&](Event event) {
+        if (event == Event::Return) {
+            apply_time();
+            return true;
+        }
+        return false;
     });
     
-    auto copy_button = Button("Copy Filtered", [&] {
-        // Get filtered entries (same logic as in log renderer)
-        std::vector<LogEntry> filtered_entries;
-        bool any_filter_checked = show_debug || show_info || show_warn || show_error;
+    auto parse_button = Button("Open", [&] {
+        // Stop the previous load, search and export before dropping the storage they use
+        parser.stopParsing();
+        filter_index.cancel();
+        trigram_index.cancel();
+        export_worker.cancel();
+        summary_worker.cancel();
         
-        // Thread-safe access to log entries
-        std::vector<LogEntry> local_entries;
+        // Free the previous file's entries and text in one go
         {
             std::lock_guard<std::mutex> lock(log_entries_mutex);
-            local_entries = log_entries;
+            log_store.clear();
         }
+        scroll_y = 0;
         
-        for (const auto& entry : local_entries) {
-            // Apply level filters
-            bool level_matches = !any_filter_checked || 
-                (show_debug && entry.level == LogLevel::DEBUG) ||
-                (show_info && entry.level == LogLevel::INFO) ||
-                (show_warn && entry.level == LogLevel::WARN) ||
-                (show_error && entry.level == LogLevel::ERROR);
-            
-            if (!level_matches) continue;
-            
-            // Apply search filter
-            if (!search_term.empty() && 
-                entry.message.find(search_term) == std::string::npos) {
-                continue;
-            }
-            
-            filtered_entries.push_back(entry);
-        }
+        auto progress_callback = [&](const std::string& progress) {
+            status_message = progress;
+            // Force UI refresh
+            screen.PostEvent(Event::Custom);
+        };
         
-        // Build clipboard text
-        std::string clipboard_text;
-        for (const auto& entry : filtered_entries) {
-            std::string source_info = entry.source_file + ":" + std::to_string(entry.source_line);
-            clipboard_text += "[" + entry.timestamp + "][" + LogLevelToString(entry.level) + "]: " + 
-                             entry.message + " | " + source_info + "\n";
+        // Several files (or a wildcard) open as one view merged by time
+        std::vector<std::string> paths;
+        if (!SocketListener::isEndpoint(input_file_path)) {
+            paths = expandInputPaths(input_file_path);
         }
         
-        if (copyToClipboard(clipboard_text)) {
-            status_message = "Copied " + std::to_string(filtered_entries.size()) + " entries to clipboard";
+        // Start async parsing with progress callback
+        if (SocketListener::isEndpoint(input_file_path)) {
+            parser.listenAsync(input_file_path, log_store, log_entries_mutex, progress_callback);
+        } else if (paths.empty()) {
+            status_message = "No files match " + input_file_path;
+        } else if (paths.size() > 1 && use_follow) {
+            status_message = "Follow mode needs a single file";
+        } else if (paths.size() > 1) {
+            parser.parseMergedAsync(paths, log_store, log_entries_mutex, progress_callback);
+        } else if (use_follow) {
+            parser.followAsync(paths[0], log_store, log_entries_mutex, progress_callback);
+        } else if (use_mmap) {
+            parser.setLazyDecoding(use_lazy);
+            parser.parseMappedAsync(paths[0], log_store, log_entries_mutex, progress_callback);
         } else {
-            status_message = "Failed to copy to clipboard";
+            parser.parseAsync(paths[0], log_store, log_entries_mutex, progress_callback);
         }
-        screen.PostEvent(Event::Custom);
+        
+        saveLastFilePath(input_file_path);
+        input_search->TakeFocus();
     });
     
+    // File name a row of a merged view came from
+    auto origin_label = [&](size_t row) {
+        return std::filesystem::path(log_store.originName(log_store.origin(row))).filename().string();
+    };
+    
+    // Copy and Export stream the filtered entries from a background
+    // worker, straight from the store to the clipboard tool or the file
+    auto export_filtered = [&](ExportTarget target) {
+        if (export_worker.isRunning()) {
+            status_message = "An export is already running";
+            return;
+        }
+        if (target == ExportTarget::FILE && export_path.empty()) {
+            status_message = "Enter a file to export to";
+            return;
+        }
+        export_worker.start(log_store, current_filter(), target, export_path, OutputFormat::TEXT,
+                            [&](const std::string& progress) {
+            status_message = progress;
+            screen.PostEvent(Event::Custom);
+        });
+    };
+    auto copy_button = Button("Copy Filtered", [&] { export_filtered(ExportTarget::CLIPBOARD); });
+    auto export_button = Button("Export", [&] { export_filtered(ExportTarget::FILE); });
+    
     auto checkbox_debug = Checkbox("DEBUG", &show_debug);
     auto checkbox_info = Checkbox("INFO", &show_info);
     auto checkbox_warn = Checkbox("WARN", &show_warn);
     auto checkbox_error = Checkbox("ERROR", &show_error);
+    auto checkbox_mmap = Checkbox("mmap", &use_mmap);
+    auto checkbox_lazy = Checkbox("lazy", &use_lazy);
+    auto checkbox_index = Checkbox("index", &use_index);
+    auto checkbox_follow = Checkbox("follow", &use_follow);
+    auto checkbox_stats = Checkbox("stats", &show_stats);
+    auto checkbox_summary = Checkbox("summary", &show_summary);
 
     // -------------------------------------------------------------------------
     // Container structure
     // -------------------------------------------------------------------------
     
-    // File controls: Input field, Open button, and Copy button
+    // File controls: Input fields, Open button, and Copy and Export buttons
     auto file_controls_container = Container::Horizontal({
-        input_file,
+        Container::Vertical({
+            input_file,
+            input_export,
+        }),
+        checkbox_mmap,
+        checkbox_lazy,
+        checkbox_follow,
         parse_button,
         copy_button,
+        export_button,
     });
 
     // Search and filter controls
     auto search_filters_container = Container::Vertical({
-        input_search,
+        Container::Horizontal({
+            input_search,
+            checkbox_index,
+            checkbox_stats,
+            checkbox_summary,
+        }),
         Container::Horizontal({
             checkbox_debug,
             checkbox_info,
             checkbox_warn,
             checkbox_error,
+            input_time,
         }),
     });
 
+    // Scroll so the nearest ERROR after (or before) the top row is at the top
+    auto jump_to_error = [&](bool forward) {
+        size_t total = filter_index.size();
+        size_t top = static_cast<size_t>(scroll_y);
+        size_t found = forward ? filter_index.nextOfLevel(top, LogLevel::ERROR)
+                               : filter_index.previousOfLevel(top, LogLevel::ERROR);
+        if (found < total) {
+            scroll_y = static_cast<int>(found);
+            status_message = "ERROR at entry " + std::to_string(found + 1) + " of " + std::to_string(total);
+        } else {
+            status_message = forward ? "No ERROR entries below" : "No ERROR entries above";
+        }
+    };
+    
+    // Keys that move the view from anywhere. Home, End and letters belong
+    // to a text box while one has focus.
+    auto navigate = [&](Event event) {
+        int last_top = std::max(0, static_cast<int>(filter_index.size()) - visible_rows);
+        if (event == Event::PageUp) {
+            scroll_y = std::max(0, std::min(scroll_y, last_top) - visible_rows);
+            return true;
+        }
+        if (event == Event::PageDown) {
+            scroll_y = std::min(scroll_y + visible_rows, last_top);
+            return true;
+        }
+        if (input_file->Focused() || input_export->Focused() || input_search->Focused() || input_time->Focused()) {
+            return false;
+        }
+        if (event == Event::Home) {
+            scroll_y = 0;
+            return true;
+        }
+        if (event == Event::End) {
+            scroll_y = last_top;
+            return true;
+        }
+        if (event == Event::Character('e') || event == Event::Character('E')) {
+            jump_to_error(event == Event::Character('e'));
+            return true;
+        }
+        return false;
+    };
+
     // Log display container with scrolling support
     auto log_display_container = Container::Vertical({}) | CatchEvent([&](Event event) {
         if (event == Event::ArrowUp && scroll_y > 0) {
@@ -313,20 +664,31 @@ int main() {
                 text("File: "),
                 input_file->Render() | flex,
             }),
-            text(""),  // Padding
+            hbox({
+                text("Export: "),
+                input_export->Render() | flex,
+            }),
             hbox({
                 text("Status: "),
                 text(status_message) | color(Color::Green) | flex,
             }),
         });
         
-        // Right side: Open and Copy buttons
+        // Right side: Open, Copy and Export buttons
         auto right_section = vbox({
             filler(),
             hbox({
+                checkbox_mmap->Render(),
+                text("  "),
+                checkbox_lazy->Render(),
+                text("  "),
+                checkbox_follow->Render(),
+                text("  "),
                 parse_button->Render(),
                 text("  "),
                 copy_button->Render(),
+                text("  "),
+                export_button->Render(),
             }),
             filler(),
         });
@@ -339,52 +701,67 @@ int main() {
     });
     
     // Log display renderer (center pane)
+    // The header never changes, and visible rows are kept between frames
+    const Element single_header = buildHeader(false);
+    const Element merged_header = buildHeader(true);
+    RowCache row_cache;
+    
     auto log_renderer = Renderer(log_display_container, [&] {
-        // Filter log entries (but only store indices to avoid copying)
-        std::vector<size_t> filtered_indices;
-        bool any_filter_checked = show_debug || show_info || show_warn || show_error;
+        StageTimer render_timer(MetricStage::RENDER);
         
-        // Thread-safe access to log entries
-        std::vector<LogEntry> local_entries;
-        {
-            std::lock_guard<std::mutex> lock(log_entries_mutex);
-            local_entries = log_entries;  // Make a copy for processing
+        // Read the store in place without locking: rows below size() never
+        // change or move while the parser appends
+        
+        // Index a fully loaded file (after its first paint), or drop the
+        // index when it's switched off
+        if (use_index && !log_store.empty() && !parser.isParsingInProgress() && !trigram_index.isBuilding() &&
+            (!trigram_index.isReady() || trigram_index.generation() != log_store.generation())) {
+            trigram_index.build(log_store, log_store.size(), [&] { screen.PostEvent(Event::Custom); });
+        } else if (!use_index && (trigram_index.isReady() || trigram_index.isBuilding())) {
+            trigram_index.cancel();
         }
         
-        for (size_t i = 0; i < local_entries.size(); ++i) {
-            const auto& entry = local_entries[i];
-            // Apply level filters
-            bool level_matches = !any_filter_checked || 
-                (show_debug && entry.level == LogLevel::DEBUG) ||
-                (show_info && entry.level == LogLevel::INFO) ||
-                (show_warn && entry.level == LogLevel::WARN) ||
-                (show_error && entry.level == LogLevel::ERROR);
-            
-            if (!level_matches) continue;
-            
-            // Apply search filter
-            if (!search_term.empty() && 
-                entry.message.find(search_term) == std::string::npos) {
-                continue;
-            }
-            
-            filtered_indices.push_back(i);
-        }
-
-        // Create header
-        Elements header_cells;
-        header_cells.push_back(text("Timestamp") | bold | color(Color::RGB(255, 215, 0)) | center | size(WIDTH, EQUAL, 15));
-        header_cells.push_back(separator());
-        header_cells.push_back(text("Level") | bold | color(Color::RGB(255, 215, 0)) | center | size(WIDTH, EQUAL, 10));
-        header_cells.push_back(separator());
-        header_cells.push_back(text("Message") | bold | color(Color::RGB(255, 215, 0)) | flex);
-        header_cells.push_back(separator());
-        header_cells.push_back(text("Source") | bold | color(Color::RGB(255, 215, 0)) | size(WIDTH, EQUAL, 50));
-        auto header = hbox(std::move(header_cells));
-
-        // Virtualization: only render visible rows (max 45 to fit in our height limit)
-        const int max_visible_rows = 45;
-        const int total_filtered = filtered_indices.size();
+        // Filter log entries (only new entries are tested unless the filter
+        // changed); network ingest waits while the rows tested, by this or
+        // a background search, fall too far behind
+        filter_index.update(log_store, current_filter());
+        parser.setViewedRows(filter_index.scannedRows());
+        
+        // Go to time: binary search the time index, then find that row's position
+        if (seek_clock >= 0) {
+            size_t row = log_store.timeIndex().seek(seek_clock, log_store.size());
+            scroll_y = static_cast<int>(filter_index.lowerBound(row));
+            status_message = row < log_store.size() ? "Jumped to " + time_text : "No entries at or after " + time_text;
+            seek_clock = -1;
+        }
+        if (seek_percent >= 0) {
+            int last_top = std::max(0, static_cast<int>(filter_index.size()) - visible_rows);
+            scroll_y = static_cast<int>(static_cast<int64_t>(last_top) * seek_percent / 100);
+            status_message = "Jumped to " + time_text;
+            seek_percent = -1;
+        }
+
+        const bool merged = log_store.isMerged();
+        const Element& header = merged ? merged_header : single_header;
+
+        // Virtualization: only the rows that fit are read, straight from
+        // their filtered positions. The rows fit where the previous frame
+        // drew them; on the first frame or after a resize the room is
+        // estimated from the other panes' heights.
+        const Dimensions terminal = Terminal::Size();
+        const int estimated_rows = terminal.dimy - FILE_PANE_HEIGHT - SEARCH_PANE_HEIGHT - 2 - LOG_PANE_CHROME;
+        const int max_visible_rows = std::max(1, log_box_height == terminal.dimy && log_box.y_max >= log_box.y_min
+                                                     ? log_box.y_max - log_box.y_min + 1
+                                                     : estimated_rows);
+        log_box_height = terminal.dimy;
+        visible_rows = max_visible_rows;
+        const int total_filtered = static_cast<int>(filter_index.size());
+        
+        // While following, a view scrolled to the end stays there as lines arrive
+        if (parser.isFollowing() && scroll_y >= last_filtered - max_visible_rows) {
+            scroll_y = std::max(0, total_filtered - max_visible_rows);
+        }
+        last_filtered = total_filtered;
         
         // Clamp scroll position
         if (scroll_y >= total_filtered) {
@@ -396,22 +773,30 @@ int main() {
         int start_idx = scroll_y;
         int end_idx = std::min(start_idx + max_visible_rows, total_filtered);
         
-        // Create log rows only for visible entries
+        // Create log rows only for visible entries, reusing the ones still on screen
+        const int terminal_width = terminal.dimx;
+        row_cache.beginFrame(log_store.generation(), terminal_width, merged);
         Elements log_rows;
         for (int i = start_idx; i < end_idx; ++i) {
-            const auto& entry = local_entries[filtered_indices[i]];
-            std::string source_info = entry.source_file + ":" + std::to_string(entry.source_line);
-            
-            auto log_row = hbox({
-                text(entry.timestamp) | size(WIDTH, EQUAL, 15),
-                separator(),
-                text(LogLevelToString(entry.level)) | color(LogLevelToColor(entry.level)) | size(WIDTH, EQUAL, 10),
-                separator(),
-                text(entry.message) | flex,
-                separator(),
-                text(source_info) | size(WIDTH, EQUAL, 50) | dim,
-            });
-            log_rows.push_back(log_row);
+            size_t row = filter_index[i];
+            log_rows.push_back(row_cache.row(row, [&] {
+                LogEntryView entry = log_store[row];
+                std::string source_info = std::string(entry.source_file) + ":" + std::to_string(entry.source_line);
+                
+                Elements cells;
+                if (merged) {
+                    cells.push_back(text(origin_label(row)) | size(WIDTH, EQUAL, 20) | color(Color::Magenta));
+                    cells.push_back(separator());
+                }
+                cells.push_back(text(std::string(entry.timestamp)) | size(WIDTH, EQUAL, 15));
+                cells.push_back(separator());
+                cells.push_back(text(LogLevelToString(entry.level)) | color(LogLevelToColor(entry.level)) | size(WIDTH, EQUAL, 10));
+                cells.push_back(separator());
+                cells.push_back(text(clipToWidth(entry.message, terminal_width)) | flex);
+                cells.push_back(separator());
+                cells.push_back(text(source_info) | size(WIDTH, EQUAL, 50) | dim);
+                return hbox(std::move(cells));
+            }));
         }
         
         Element log_content = log_rows.empty() 
@@ -419,7 +804,13 @@ int main() {
             : vbox(std::move(log_rows)) | vscroll_indicator | frame;
 
         std::string log_status = "Showing " + std::to_string(total_filtered) + 
-                               " of " + std::to_string(local_entries.size()) + " entries";
+                               " of " + std::to_string(log_store.size()) + " entries";
+        if (filter_index.searching()) {
+            log_status += " (searching...)";
+        }
+        if (trigram_index.isBuilding()) {
+            log_status += " (indexing...)";
+        }
         
         // Add scroll position indicator for large datasets
         std::string scroll_info = "";
@@ -436,7 +827,7 @@ int main() {
             separator(),
             header,
             separator(),
-            log_content | flex,
+            log_content | flex | reflect(log_box),
         }) | border;
     });
 
@@ -446,6 +837,12 @@ int main() {
             hbox({
                 text("Search: ") | size(WIDTH, EQUAL, 8),
                 input_search->Render() | flex,
+                text(" "),
+                checkbox_index->Render(),
+                text(" "),
+                checkbox_stats->Render(),
+                text(" "),
+                checkbox_summary->Render(),
             }),
             separator(),
             hbox({
@@ -457,6 +854,8 @@ int main() {
                 checkbox_warn->Render(),
                 text(" "),
                 checkbox_error->Render(),
+                text("   Time: "),
+                input_time->Render() | size(WIDTH, EQUAL, 28),
             }),
         }) | border;
     });
@@ -471,14 +870,163 @@ int main() {
         search_renderer,
     });
 
+    // Stats overlay: per-stage timings, throughput over the last interval and memory
+    MetricsSnapshot stats_previous = metricsSnapshot();
+    double parsed_per_second = 0;
+    double appended_per_second = 0;
+    auto stats_overlay = [&] {
+        MetricsSnapshot stats = metricsSnapshot();
+        double interval = std::chrono::duration<double>(stats.taken - stats_previous.taken).count();
+        if (interval >= 0.5) {
+            parsed_per_second = (stats[MetricStage::PARSE].items - stats_previous[MetricStage::PARSE].items) / interval;
+            appended_per_second = (stats[MetricStage::APPEND].items - stats_previous[MetricStage::APPEND].items) / interval;
+            stats_previous = stats;
+        }
+        
+        auto cell = [](const std::string& value, int width) {
+            return text(value) | size(WIDTH, EQUAL, width);
+        };
+        Elements rows;
+        rows.push_back(hbox({
+            cell("stage", 8), cell("samples", 10), cell("last ms", 10), cell("avg ms", 10), cell("max ms", 10),
+        }) | bold);
+        for (size_t s = 0; s < static_cast<size_t>(MetricStage::COUNT); ++s) {
+            const StageStats& stage = stats.stages[s];
+            rows.push_back(hbox({
+                cell(metricStageName(static_cast<MetricStage>(s)), 8),
+                cell(std::to_string(stage.samples), 10),
+                cell(formatMs(stage.last_ns), 10),
+                cell(formatMs(stage.samples ? stage.total_ns / stage.samples : 0), 10),
+                cell(formatMs(stage.max_ns), 10),
+            }));
+        }
+        rows.push_back(separator());
+        rows.push_back(text("Parsed: " + std::to_string(static_cast<size_t>(parsed_per_second)) + " entries/s, appended: " +
+                            std::to_string(static_cast<size_t>(appended_per_second)) + " rows/s"));
+        rows.push_back(text("Memory: " + (stats.resident_bytes ? formatMb(stats.resident_bytes) : std::string("n/a")) +
+                            " resident, " + formatMb(log_store.arenaBytes()) + " arenas, " +
+                            formatMb(trigram_index.isReady() ? trigram_index.memoryBytes() : 0) + " trigram index"));
+        rows.push_back(text(trace_path ? std::string("Tracing to ") + trace_path : "Set LOGREADER_TRACE=file.json to trace") | dim);
+        return window(text(" Stats "), vbox(std::move(rows))) | clear_under;
+    };
+    
+    // Summary overlay: counts over the current filter, recounted when the
+    // filter changes and at most twice a second while entries arrive
+    const auto SUMMARY_INTERVAL = std::chrono::milliseconds(500);
+    LogFilter summary_filter;
+    size_t summary_rows = 0;
+    uint64_t summary_generation = 0;
+    size_t summary_buckets = 0;
+    auto summary_started = std::chrono::steady_clock::now();
+    auto summary_overlay = [&] {
+        const int width = std::clamp(Terminal::Size().dimx - 6, 40, 120);
+        const size_t buckets = static_cast<size_t>(width - 2);
+        LogFilter filter = current_filter();
+        auto now = std::chrono::steady_clock::now();
+        bool changed = filter != summary_filter || log_store.generation() != summary_generation ||
+                       buckets != summary_buckets;
+        bool grown = log_store.size() != summary_rows && now - summary_started >= SUMMARY_INTERVAL;
+        if (changed || (grown && !summary_worker.isRunning())) {
+            summary_filter = filter;
+            summary_rows = log_store.size();
+            summary_generation = log_store.generation();
+            summary_buckets = buckets;
+            summary_started = now;
+            summary_worker.start(log_store, filter, buckets, [&] { screen.PostEvent(Event::Custom); });
+        }
+        
+        std::shared_ptr<const LogSummary> summary = summary_worker.result();
+        if (!summary) {
+            return window(text(" Summary "), text("Counting...") | dim) | size(WIDTH, EQUAL, width) | clear_under;
+        }
+        
+        auto cell = [](const std::string& value, int cell_width) {
+            return text(value) | size(WIDTH, EQUAL, cell_width);
+        };
+        Elements rows;
+        rows.push_back(text(std::to_string(summary->entries) + " entries, counted in " +
+                            std::to_string(static_cast<int>(summary->elapsed_ms)) + " ms" +
+                            (summary_worker.isRunning() ? " (updating...)" : "")));
+        Elements level_cells;
+        for (LogLevel level : {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARN, LogLevel::ERROR}) {
+            level_cells.push_back(text(LogLevelToString(level) + " " +
+                                       std::to_string(summary->levels[static_cast<size_t>(level)]) + "  ") |
+                                  color(LogLevelToColor(level)));
+        }
+        rows.push_back(hbox(std::move(level_cells)));
+        
+        // The busiest sources, with their WARN and ERROR shares
+        const size_t GROUP_ROWS = 6;
+        auto group_table = [&](const char* title, const std::vector<LogSummary::Group>& groups, size_t distinct) {
+            rows.push_back(separator());
+            rows.push_back(hbox({
+                cell(std::string(title) + " (" + std::to_string(distinct) + ")", width - 32),
+                cell("entries", 12), cell("WARN", 10), cell("ERROR", 10),
+            }) | bold);
+            for (size_t i = 0; i < groups.size() && i < GROUP_ROWS; ++i) {
+                const LogSummary::Group& group = groups[i];
+                rows.push_back(hbox({
+                    cell(clipToWidth(group.name, width - 34), width - 32),
+                    cell(std::to_string(group.total), 12),
+                    cell(std::to_string(group.levels[static_cast<size_t>(LogLevel::WARN)]), 10) | color(Color::Yellow),
+                    cell(std::to_string(group.levels[static_cast<size_t>(LogLevel::ERROR)]), 10) | color(Color::Red),
+                }));
+            }
+        };
+        group_table("Functions", summary->functions, summary->function_count);
+        group_table("Source files", summary->files, summary->file_count);
+        
+        // Entries and ERRORs over time, one column per bucket
+        if (!summary->buckets.empty()) {
+            std::string per = " per " + formatWidth(summary->bucket_ms);
+            int64_t end_clock = summary->bucket_start + summary->bucket_ms * static_cast<int64_t>(summary->buckets.size());
+            uint64_t peak = *std::max_element(summary->buckets.begin(), summary->buckets.end());
+            auto error_peak = std::max_element(summary->error_buckets.begin(), summary->error_buckets.end());
+            int64_t error_peak_clock = summary->bucket_start +
+                                       summary->bucket_ms * (error_peak - summary->error_buckets.begin());
+            rows.push_back(separator());
+            rows.push_back(text("Entries" + per + ", " + TimeIndex::formatClock(summary->bucket_start) + " to " +
+                                TimeIndex::formatClock(end_clock) + " (peak " + std::to_string(peak) + ")"));
+            rows.push_back(text(sparkline(summary->buckets, peak)) | color(Color::Green));
+            rows.push_back(text("ERROR" + per + (*error_peak ? " (peak " + std::to_string(*error_peak) + " at " +
+                                TimeIndex::formatClock(error_peak_clock) + ")" : std::string(": none"))));
+            rows.push_back(text(sparkline(summary->error_buckets, *error_peak)) | color(Color::Red));
+        }
+        return window(text(" Summary "), vbox(std::move(rows))) | size(WIDTH, EQUAL, width) | clear_under;
+    };
+    
     auto final_renderer = Renderer(main_renderer, [&] {
-        return vbox({
-            file_renderer->Render() | size(HEIGHT, EQUAL, 5),
+        Element layout = vbox({
+            file_renderer->Render() | size(HEIGHT, EQUAL, FILE_PANE_HEIGHT),
             separator(),
-            log_renderer->Render() | size(HEIGHT, EQUAL, 50),
+            log_renderer->Render() | flex,
             separator(),
-            search_renderer->Render() | size(HEIGHT, EQUAL, 6),
+            search_renderer->Render() | size(HEIGHT, EQUAL, SEARCH_PANE_HEIGHT),
         });
+        if (!show_summary && summary_worker.isRunning()) {
+            summary_worker.cancel();
+            summary_buckets = 0;   // Count again when it's shown
+        }
+        if (!show_stats && !show_summary) {
+            return layout;
+        }
+        Elements overlays;
+        overlays.push_back(layout);
+        if (show_summary) {
+            overlays.push_back(vbox({
+                text("") | size(HEIGHT, EQUAL, FILE_PANE_HEIGHT + 2),
+                hbox({text("  "), summary_overlay(), filler()}),
+                filler(),
+            }));
+        }
+        if (show_stats) {
+            overlays.push_back(vbox({
+                text("") | size(HEIGHT, EQUAL, FILE_PANE_HEIGHT + 2),
+                hbox({filler(), stats_overlay(), text("  ")}),
+                filler(),
+            }));
+        }
+        return dbox(std::move(overlays));
     });
 
     // Add escape key handling
@@ -487,7 +1035,7 @@ int main() {
             screen.ExitLoopClosure()();
             return true;
         }
-        return false;
+        return navigate(event);
     });
 
     // -------------------------------------------------------------------------
@@ -495,7 +1043,12 @@ int main() {
     // -------------------------------------------------------------------------
     screen.Loop(escape_handler);
     
-    // Clean up parser thread before exit
+    // Clean up parser and export threads before exit
     parser.stopParsing();
+    export_worker.cancel();
+    summary_worker.cancel();
+    if (trace_path && !writeChromeTrace(trace_path)) {
+        std::cerr << "log_reader: cannot write trace " << trace_path << std::endl;
+    }
     return 0;
 }
\ No newline at end of file
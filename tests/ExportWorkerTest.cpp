@@ -0,0 +1,86 @@
+// Export of a store fed by network streams: a host that connects while the
+// export runs must have its rows written under its own name. Exits 0 on
+// success.
+//
+//   export_worker_test
+
+#include "ExportWorker.hpp"
+#include "LineParser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+// Rows of origin, as a stream's batches are built by the ingest
+static LogBatch makeBatch(const char* message, size_t count, uint16_t origin) {
+    LogBatch batch(true);
+    for (size_t i = 0; i < count; ++i) {
+        std::string line = "16:29:40.318";
+        line += FIELD_SEPARATOR;
+        line += "INFO";
+        line += FIELD_SEPARATOR;
+        line += message + std::to_string(i);
+        line += FIELD_SEPARATOR;
+        line += "Node.cpp -> send(): 1";
+        LogEntryView entry;
+        parseLogLine(line, entry);
+        batch.add(entry);
+    }
+    batch.setOrigin(origin);
+    return batch;
+}
+
+int main() {
+    const size_t EARLY_ROWS = 2000000;
+    const size_t LATE_ROWS = 1000;
+    std::string path = (std::filesystem::temp_directory_path() / "export_worker_test.txt").string();
+
+    LogStore store;
+    store.append(makeBatch("match early ", EARLY_ROWS, store.addOrigin("node-a")));
+
+    // The search over the early rows keeps the export running while the
+    // second host connects and sends, once rows are being written
+    LogFilter filter;
+    filter.search_term = "match";
+    std::string last_status;
+    ExportWorker worker;
+    worker.start(store, filter, ExportTarget::FILE, path, OutputFormat::TEXT,
+                 [&](const std::string& status) { last_status = status; });
+    auto writing = [&] {
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        return !error && size > 0;
+    };
+    auto started = std::chrono::steady_clock::now();
+    while (worker.isRunning() && !writing() && std::chrono::steady_clock::now() - started < std::chrono::seconds(10)) {
+        std::this_thread::yield();
+    }
+    store.append(makeBatch("match late ", LATE_ROWS, store.addOrigin("node-b")));
+    while (worker.isRunning()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    size_t early = 0;
+    size_t late = 0;
+    size_t other = 0;
+    std::ifstream exported(path);
+    for (std::string line; std::getline(exported, line);) {
+        if (line.rfind("node-a: ", 0) == 0 && line.find("match early ") != std::string::npos) {
+            early++;
+        } else if (line.rfind("node-b: ", 0) == 0 && line.find("match late ") != std::string::npos) {
+            late++;
+        } else {
+            other++;
+        }
+    }
+    exported.close();
+    std::filesystem::remove(path);
+
+    std::printf("%s\n%zu node-a rows, %zu node-b rows, %zu others\n", last_status.c_str(), early, late, other);
+    bool passed = early == EARLY_ROWS && late == LATE_ROWS && other == 0;
+    std::printf("%s\n", passed ? "PASS" : "FAIL");
+    return passed ? 0 : 1;
+}